@@ -0,0 +1,56 @@
+/*
+	MIT License
+
+	Copyright 2021 Mario Sieg "pinsrq" <mt3000@gmx.de>
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+ */
+
+/*
+ * Module interface of extended_variant.hpp.
+ * The standard headers are parsed in the global module fragment, the library itself in the module purview with every name exported,
+ * so importers skip parsing it together with <variant>, <tuple>, <functional> and <optional>.
+ * Macros can not be exported, STDEX_VARIANT_EXTERN and friends still require the header.
+ * The opt-in extended_variant_*.hpp headers are not part of the module, they include extended_variant.hpp themselves.
+ */
+
+module;
+
+#include <array>
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+export module stdex.extended_variant;
+
+#define STDEX_EXPORT export
+#include "extended_variant.hpp"
@@ -25,12 +25,52 @@
 #ifndef EXTENDED_VARIANT_HPP
 #define EXTENDED_VARIANT_HPP
 
+/* Maximum number of types stdex::type_registry can assign ids to. */
+#ifndef STDEX_TYPE_REGISTRY_CAPACITY
+#define STDEX_TYPE_REGISTRY_CAPACITY 4096
+#endif
+
+/* Whether the compiler provides __type_pack_element, used for O(1) type list indexing. */
+#ifndef STDEX_HAS_TYPE_PACK_ELEMENT
+#if defined(__has_builtin)
+#if __has_builtin(__type_pack_element)
+#define STDEX_HAS_TYPE_PACK_ELEMENT 1
+#endif
+#endif
+#endif
+#ifndef STDEX_HAS_TYPE_PACK_ELEMENT
+#define STDEX_HAS_TYPE_PACK_ELEMENT 0
+#endif
+
+/* Whether the compiler provides __builtin_bit_cast, used to load trivially copyable types without default constructing them. */
+#ifndef STDEX_HAS_BUILTIN_BIT_CAST
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_bit_cast)
+#define STDEX_HAS_BUILTIN_BIT_CAST 1
+#endif
+#endif
+#endif
+#ifndef STDEX_HAS_BUILTIN_BIT_CAST
+#define STDEX_HAS_BUILTIN_BIT_CAST 0
+#endif
+
+/* Exports the library from the module interface unit extended_variant.cppm, empty when used as a header. */
+#ifndef STDEX_EXPORT
+#define STDEX_EXPORT
+#endif
+
 #include <array>
 #include <algorithm>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <exception>
 #include <functional>
+#include <iterator>
 #include <limits>
+#include <memory>
+#include <new>
 #include <optional>
 #include <tuple>
 #include <type_traits>
@@ -38,7 +78,7 @@
 #include <variant>
 
 // std extensions
-namespace stdex
+STDEX_EXPORT namespace stdex
 {
 	namespace detail
 	{
@@ -78,6 +118,23 @@ namespace stdex
 			(*static_cast<T*>(blob)).~T();
 		}
 
+		/* Loads a trivially copyable T from possibly misaligned bytes. Without __builtin_bit_cast, T must be default constructible. */
+		template <typename T>
+		inline auto load_as(const void* const source) noexcept(true) -> T
+		{
+			static_assert(std::is_trivially_copyable_v<T>, "Only trivially copyable types can be loaded from bytes!");
+#if STDEX_HAS_BUILTIN_BIT_CAST
+			std::array<std::byte, sizeof(T)> bytes;
+			std::memcpy(bytes.data(), source, sizeof(T));
+			return __builtin_bit_cast(T, bytes);
+#else
+			static_assert(std::is_default_constructible_v<T>, "Loading requires default constructible types without __builtin_bit_cast!");
+			T value;
+			std::memcpy(std::addressof(value), source, sizeof(T));
+			return value;
+#endif
+		}
+
 		/* Queries discriminator data types depending on generic type count. */
 		template <const std::size_t N>
 		struct discriminator final
@@ -112,216 +169,2884 @@ namespace stdex
 		/* Validate single type. */
 		template <typename... Ts>
 		constexpr auto monotonic_validator_v {monotonic_validator<Ts...>::value};
-	}
 
-	/* A cleaner and more intuitive std::variant alternative. */
-	template <typename... Ts>
-	class variant final
-	{
-	public:
-		struct detail final
+		/*
+		 * Invokes the functor with std::integral_constant<std::size_t, idx> for an index in range [I, N).
+		 * The last index is taken without comparison, so idx must be inside the range.
+		 */
+		template <typename R, const std::size_t I, const std::size_t N, typename F>
+		inline auto dispatch_index(const std::size_t idx, F&& functor) -> R
 		{
-			/* Validate generic types: */
-			static_assert(sizeof...(Ts), "Type list must be above zero!");
-			static_assert(sizeof...(Ts) < std::numeric_limits<std::size_t>::max(), "Type count must <= size_t::max!");
-			static_assert(stdex::detail::monotonic_validator<Ts...>::value, "Types must be destructible objects and no arrays!");
-
-			/* The maximum size of one type in the collection. */
-			static constexpr std::size_t max_size {std::max({sizeof(Ts)...})};
-
-			/* The maximum alignment of one type in the collection. */
-			static constexpr std::size_t max_align {std::max({alignof(Ts)...})};
-
-			/* A normal std::variant holding the types. */
-			using std_variant = std::variant<Ts...>;
-
-			/* A normal std::tuple holding the types. */
-			using std_tuple = std::tuple<Ts...>;
+			if constexpr (I + 1 >= N)
+			{
+				return std::invoke(std::forward<F>(functor), std::integral_constant<std::size_t, I> { });
+			}
+			else
+			{
+				if (idx == I)
+				{
+					return std::invoke(std::forward<F>(functor), std::integral_constant<std::size_t, I> { });
+				}
+				return dispatch_index<R, I + 1, N>(idx, std::forward<F>(functor));
+			}
+		}
 
-			/* First type. */
-			using first = std::tuple_element_t<0, std_tuple>;
+		/* Index of the first T in Ts, or the type count if T is not contained. */
+		template <typename T, typename... Ts>
+		constexpr auto index_of_type() noexcept(true) -> std::size_t
+		{
+			std::size_t r {0};
+			((std::is_same_v<T, Ts> ? false : (++r, true)) && ...);
+			return r;
+		}
 
-			/* Last type. */
-			using last = std::tuple_element_t<sizeof...(Ts) - 1, std_tuple>;
+		/* Only callable if U converts to T without narrowing. */
+		template <typename T>
+		auto narrowing_probe(T (&&)[1]) -> void;
 
-			/* The type used to store the data. */
-			using storage = std::array<std::byte, max_size>;
+		/* Imaginary overload F(T) of the converting constructor, which only exists if U converts to T without narrowing. */
+		template <typename U, const std::size_t I, typename T, typename = void>
+		struct converting_overload
+		{
+			auto operator ()() const -> void;
+		};
 
-			/* Direct discriminator type. */
-			using discriminator_v = typename stdex::detail::discriminator<sizeof...(Ts)>::type;
+		template <typename U, const std::size_t I, typename T>
+		struct converting_overload<U, I, T, std::void_t<decltype(narrowing_probe<T>({std::declval<U>()}))>>
+		{
+			auto operator ()(T) const -> std::integral_constant<std::size_t, I>;
 		};
 
-		using discriminator_v = typename detail::discriminator_v;
-		using storage_v = typename detail::storage;
+		template <typename U, typename S, typename... Ts>
+		struct converting_overloads;
 
-	private:
-		/* Data storage. */
-		alignas(detail::max_align) storage_v storage_;
+		template <typename U, const std::size_t... Is, typename... Ts>
+		struct converting_overloads<U, std::index_sequence<Is...>, Ts...> : converting_overload<U, Is, Ts>...
+		{
+			using converting_overload<U, Is, Ts>::operator ()...;
+		};
 
-		/* Index. */
-		discriminator_v discriminator_;
+		/* Overload resolution over all alternatives, the type count if no unique best overload exists. */
+		template <typename U, typename = void, typename... Ts>
+		struct converting_resolution final
+		{
+			static constexpr std::size_t value {sizeof...(Ts)};
+		};
 
-		template <typename T>
-		inline auto access_as() noexcept(true) -> T&
+		template <typename U, typename... Ts>
+		struct converting_resolution<U, std::void_t<decltype(converting_overloads<U, std::index_sequence_for<Ts...>, Ts...> { }(std::declval<U>()))>, Ts...> final
 		{
-			return *reinterpret_cast<T*>(std::addressof(this->storage_));
-		}
+			static constexpr std::size_t value {decltype(converting_overloads<U, std::index_sequence_for<Ts...>, Ts...> { }(std::declval<U>()))::value};
+		};
 
-		template <typename T>
-		inline auto access_as() const noexcept(true) -> const T&
+		/*
+		 * Selects the alternative constructed from U.
+		 * An exact type match is found with a single fold, only otherwise the overload set of all alternatives is built,
+		 * which excludes narrowing conversions. Returns the type count if no alternative is selected.
+		 */
+		template <typename U, typename... Ts>
+		constexpr auto select_alternative() noexcept(true) -> std::size_t
 		{
-			return *reinterpret_cast<const T*>(std::addressof(this->storage_));
+			constexpr std::size_t exact {index_of_type<std::remove_cv_t<std::remove_reference_t<U>>, Ts...>()};
+			if constexpr (exact < sizeof...(Ts))
+			{
+				return exact;
+			}
+			else
+			{
+				return converting_resolution<U, void, Ts...>::value;
+			}
 		}
 
-	public:
-		/* <<< STL Interface >>> */
+		template <typename... Ty>
+		struct recursive_invoker;
+
+		/* Conversions between variant types which work on the storage directly, see stdex::widen. */
+		struct variant_access;
 
-		constexpr variant() noexcept(std::is_nothrow_constructible_v<typename detail::first>);
+		/* Members of a variant, the discriminator either follows or precedes the storage. */
+		template <typename S, typename D, const std::size_t Align, const bool TagFirst>
+		struct layout
+		{
+			alignas(Align) S storage_;
+			D discriminator_;
 
-		~variant();
+			constexpr explicit layout(const D discriminator) noexcept(true) : storage_ { }, discriminator_ {discriminator} { }
+		};
 
-		[[nodiscard]]
-		constexpr auto index() const noexcept(true) -> discriminator_v
+		template <typename S, typename D, const std::size_t Align>
+		struct layout<S, D, Align, true>
 		{
-			return this->discriminator_;
-		}
+			D discriminator_;
+			alignas(Align) S storage_;
 
-		/* <<< Extensions >>> */
+			constexpr explicit layout(const D discriminator) noexcept(true) : discriminator_ {discriminator}, storage_ { } { }
+		};
 
-		/* Returns the index of the specified type. */
+		/* Copies the bytes of value into the blob on destruction. */
 		template <typename T>
-		[[nodiscard]]
-		static constexpr auto index_of() noexcept(true) -> discriminator_v
+		struct write_back final
 		{
-			discriminator_v r {0};
-			const auto      accumulator = [&r](const bool equ) noexcept(true)
+			void* const blob;
+			const T&    value;
+
+			~write_back()
 			{
-				r += !equ;
-				return equ;
-			};
-			(accumulator(std::is_same_v<T, Ts>) || ...);
-			return r;
-		}
+				std::memcpy(this->blob, std::addressof(this->value), sizeof(T));
+			}
+		};
 
-		/* Check if variant currently holds T. */
-		template <typename T, typename = std::enable_if_t<stdex::detail::monotonic_validator_v<T>>>
-		[[nodiscard]]
-		constexpr auto holds_alternative() const noexcept(true) -> bool
-		{
-			return this->discriminator_ == index_of<T>();
-		}
+		/* Unsigned integer with the size of a scalar. */
+		template <const std::size_t Size>
+		struct scalar_bits;
 
-		/* Check if variant currently holds T and if the values match. */
-		template <typename T, typename = std::enable_if_t<stdex::detail::monotonic_validator_v<T>>>
-		[[nodiscard]]
-		inline auto holds_value(T&& other) const noexcept(true) -> bool
+		template <>
+		struct scalar_bits<1> final
 		{
-			return this->discriminator_ == index_of<T>() && this->access_as<T>() == other;
-		}
+			using type = std::uint8_t;
+		};
 
-		/* Returns optional which contains the value if T is the current type, else std::nullopt. */
-		template <typename T, typename = std::enable_if_t<stdex::detail::monotonic_validator_v<T>>>
-		[[nodiscard]]
-		inline auto get() const noexcept(true) -> std::optional<T>
+		template <>
+		struct scalar_bits<2> final
 		{
-			return this->holds_alternative<T>() ? std::optional<T> {this->access_as<T>()} : std::optional<T> {std::nullopt};
-		}
+			using type = std::uint16_t;
+		};
 
-		/*
-		 * Returns the containing value of T if T is the current type, else the default value of T.
-		 * T must be default constructible.
-		 */
-		template <typename T, typename = std::enable_if_t<::stdex::detail::monotonic_validator_v<T> && std::is_default_constructible_v<T>>>
-		[[nodiscard]]
-		inline auto get_or_default() const noexcept(true) -> T
+		template <>
+		struct scalar_bits<4> final
 		{
-			return this->holds_alternative<T>() ? this->access_as<T>() : T { };
-		}
+			using type = std::uint32_t;
+		};
 
-		/*
-		 *  Returns the containing value of T if T is the current type, else the a custom value of T.
-		 */
-		template <typename T, typename = std::enable_if_t<stdex::detail::monotonic_validator_v<T>>>
-		[[nodiscard]]
-		inline auto get_or_custom_value(T&& instead) const noexcept(true) -> T
+		template <>
+		struct scalar_bits<8> final
 		{
-			return this->holds_alternative<T>() ? this->access_as<T>() : instead;
-		}
+			using type = std::uint64_t;
+		};
 
+		/* True if T can be selected branchlessly by stdex::detail::select_scalar, the blob must hold at least sizeof(T) initialized bytes. */
+		template <typename T>
+		constexpr bool branchless_scalar
+		{
+			std::is_scalar_v<T> && std::is_trivially_copyable_v<T> && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8)
+		};
 
 		/*
-		 *  Returns the containing value of T if T is the current type, else invokes the lambda which returns a value instead.
+		 * Returns the T stored in the blob if take, else instead, without branching.
+		 * The blob is loaded unconditionally and the result is selected from both bit patterns with a mask,
+		 * so a T is only formed from the bits which are selected.
 		 */
-		template <typename T, typename F, typename... Args, typename = std::enable_if_t<stdex::detail::monotonic_validator_v<T>>>
-		[[nodiscard]]
-		inline auto get_or_invoke(F&& functor, Args&&...args) const noexcept(true) -> T
+		template <typename T>
+		inline auto select_scalar(const bool take, const void* const blob, const T& instead) noexcept(true) -> T
 		{
-			static_assert(std::is_convertible_v<decltype(std::invoke(functor, std::forward<Args>()...)), T>, "Functor must return a T convertible type!");
-			return this->holds_alternative<T>() ? this->access_as<T>() : std::invoke(functor, std::forward<Args>()...);
+			using bits = typename scalar_bits<sizeof(T)>::type;
+			bits loaded;
+			bits fallback;
+			std::memcpy(&loaded, blob, sizeof(T));
+			std::memcpy(&fallback, std::addressof(instead), sizeof(T));
+			const auto mask {static_cast<bits>(bits {0} - static_cast<bits>(take))};
+			const auto selected {static_cast<bits>((loaded & mask) | (fallback & static_cast<bits>(~mask)))};
+			T r;
+			std::memcpy(std::addressof(r), &selected, sizeof(T));
+			return r;
 		}
-	};
+
+		/* Extent of variant storage for alternatives of up to Size bytes, aligned to Align. */
+		template <const std::size_t Size, const std::size_t Align, const bool DoubleBuffered>
+		struct storage_extent final
+		{
+			/* Distance between the two buffers of double buffered storage, padded to Align so the second one is aligned as well. */
+			static constexpr std::size_t stride {DoubleBuffered ? (Size + Align - 1) / Align * Align : 0};
+
+			/* Bytes reserved for the alternatives. */
+			static constexpr std::size_t capacity {DoubleBuffered ? stride * 2 : Size};
+
+			/* Bytes of the storage, double buffered storage appends the byte selecting the active buffer. */
+			static constexpr std::size_t value {DoubleBuffered ? capacity + 1 : Size};
+		};
+	}
+
+	template <typename... Ts>
+	struct type_list;
 
 	namespace detail
 	{
-		template <typename... Ty>
-		struct recursive_invoker;
+		/* Type at index I of Ts, through the compiler builtin where available. */
+		template <const std::size_t I, typename... Ts>
+#if STDEX_HAS_TYPE_PACK_ELEMENT
+		using type_pack_element = __type_pack_element<I, Ts...>;
+#else
+		using type_pack_element = std::tuple_element_t<I, std::tuple<Ts...>>;
+#endif
 
-		template <typename T, typename... Ty>
-		struct recursive_invoker<T, Ty...> final
+		/* Concatenates type lists. */
+		template <typename... Ls>
+		struct type_list_concat;
+
+		template <>
+		struct type_list_concat<> final
 		{
-			using mapping = variant<T, Ty...>;
+			using type = type_list<>;
+		};
 
-			template <typename... Ctor>
-			static inline auto dynamic_construct(void* const blob, const typename mapping::discriminator_v idx, Ctor&&...ctor) noexcept(std::is_nothrow_constructible_v<T, Ctor...>) -> void
-			{
-				if (idx == variant<T, Ty...>::template index_of<T>())
-				{
-					construct<T>(blob, std::forward<Ctor>(ctor)...);
-				}
-				else
-				{
-					recursive_invoker<Ty...>::dynamic_construct(blob, idx, std::forward<Ctor>(ctor)...);
-				}
-			}
+		template <typename... Ts>
+		struct type_list_concat<type_list<Ts...>> final
+		{
+			using type = type_list<Ts...>;
+		};
 
-			static inline auto dynamic_destruct(void* const blob, const typename mapping::discriminator_v idx) noexcept(std::is_nothrow_destructible_v<T>) -> void
-			{
-				if (idx == mapping::template index_of<T>())
-				{
-					destruct<T>(blob);
-				}
-				else
-				{
-					recursive_invoker<Ty...>::dynamic_destruct(blob, idx);
-				}
-			}
+		template <typename... Ts, typename... Us, typename... Ls>
+		struct type_list_concat<type_list<Ts...>, type_list<Us...>, Ls...> final
+		{
+			using type = typename type_list_concat<type_list<Ts..., Us...>, Ls...>::type;
 		};
 
-		template <>
-		struct recursive_invoker<> final
+		/* Appends every T not yet contained to the list. */
+		template <typename L, typename... Ts>
+		struct type_list_append_unique;
+
+		template <typename... Ls>
+		struct type_list_append_unique<type_list<Ls...>> final
 		{
-			template <typename... Ctor>
-			static inline auto dynamic_construct(void* const, const std::size_t, Ctor&&...) noexcept(true) -> void { }
+			using type = type_list<Ls...>;
+		};
 
-			static inline auto dynamic_destruct(void* const, const std::size_t) noexcept(true) -> void { }
+		template <typename... Ls, typename T, typename... Ts>
+		struct type_list_append_unique<type_list<Ls...>, T, Ts...> final
+		{
+			using type = typename type_list_append_unique<std::conditional_t<(std::is_same_v<T, Ls> || ...), type_list<Ls...>, type_list<Ls..., T>>, Ts...>::type;
 		};
-	}
 
-	template <typename ... Ts>
-	constexpr variant<Ts...>::variant() noexcept(std::is_nothrow_constructible_v<typename detail::first>) : storage_ { }, discriminator_ {0}
-	{
-		static_assert(std::is_default_constructible_v<typename detail::first>, "Default constructor requires the first element to be default constructible!");
-		if constexpr (!std::is_scalar_v<typename detail::first>)
+		template <typename L>
+		struct type_list_unique;
+
+		template <typename... Ts>
+		struct type_list_unique<type_list<Ts...>> final
 		{
-			stdex::detail::construct<typename detail::first>(std::addressof(this->storage_));
-		}
+			using type = typename type_list_append_unique<type_list<>, Ts...>::type;
+		};
 	}
 
-	template <typename ... Ts>
-	inline variant<Ts...>::~variant()
+	/*
+	 * A list of types which is never instantiated as a value.
+	 * Unlike std::tuple and std::variant it does not instantiate any machinery for its types,
+	 * and every operation is a member template, so only the operations used are instantiated.
+	 */
+	template <typename... Ts>
+	struct type_list final
 	{
-		stdex::detail::recursive_invoker<Ts...>::dynamic_destruct(std::addressof(this->storage_), this->discriminator_);
-	}
-}
+		static constexpr std::size_t size {sizeof...(Ts)};
+
+		/* Type at index I. */
+		template <const std::size_t I>
+		using at = stdex::detail::type_pack_element<I, Ts...>;
+
+		/* Index of the first T, or size if T is not contained. */
+		template <typename T>
+		static constexpr std::size_t index_of {stdex::detail::index_of_type<T, Ts...>()};
+
+		template <typename T>
+		static constexpr bool contains {index_of<T> < size};
+
+		/* The list with F<T> for every T. */
+		template <template <typename> typename F>
+		using map = type_list<F<Ts>...>;
+
+		/* The list of every T for which P<T>::value is true. */
+		template <template <typename> typename P>
+		using filter = typename stdex::detail::type_list_concat<std::conditional_t<P<Ts>::value, type_list<Ts>, type_list<>>...>::type;
+
+		/* The list followed by Us. */
+		template <typename... Us>
+		using append = type_list<Ts..., Us...>;
+
+		/* C<Ts...>, for example std::variant or std::tuple, only instantiated where it is completed. */
+		template <template <typename...> typename C>
+		using apply = C<Ts...>;
+	};
+
+	/*
+	 * The list L without duplicates, keeping the first occurrence of each type.
+	 * Not a member of stdex::type_list, because a member alias would be computed for every list.
+	 */
+	template <typename L>
+	using unique_t = typename stdex::detail::type_list_unique<L>::type;
+
+	/*
+	 * Position of the discriminator relative to the storage.
+	 * The storage is a byte array aligned to its alternatives, so a leading tag is always padded to that alignment
+	 * and after is never larger than before. The tag is never stored in the tail padding of an alternative,
+	 * because copying a trivially copyable alternative may overwrite its padding.
+	 */
+	enum class tag_placement
+	{
+		/* Discriminator first, for code reading the tag at offset zero. */
+		before,
+
+		/* Discriminator behind the storage, the default and never larger. */
+		after
+	};
+
+	/* How visit branches to the handler of the current alternative. */
+	enum class dispatch_strategy
+	{
+		/* Compares the index with every alternative in turn. */
+		if_chain,
+
+		/* A switch statement, which compilers usually lower to a jump table or a compare tree. */
+		switch_case,
+
+		/* An array of function pointers, indexed by the discriminator. */
+		jump_table,
+
+		/* Bisects the index range, log2(N) compares with small handlers inlined into the leaves. */
+		binary_search,
+
+		/* An if-chain for up to 3 alternatives, a switch for up to 64 and a jump table above. */
+		automatic
+	};
+
+	/*
+	 * The default policy of stdex::variant.
+	 * Custom policies derive from it and hide the members they want to change.
+	 */
+	struct variant_policy
+	{
+		/*
+		 * A variant never loses its value, so visiting never needs a valueless check.
+		 * With a single buffer the new alternative is constructed in a temporary if its constructor might throw
+		 * and moved in afterwards, so assignment requires nothrow move constructible alternatives.
+		 * With a double buffer the new alternative is constructed next to the current one, which lifts that requirement
+		 * at the cost of twice detail::max_size (rounded up to detail::max_align) of storage.
+		 */
+		static constexpr bool double_buffered {false};
+
+		/* Minimum alignment of the storage, the natural alignment detail::max_align is used if it is stricter. */
+		static constexpr std::size_t alignment {0};
+
+		/*
+		 * Stores the alternatives unaligned, so arrays of variants contain no padding.
+		 * Requires trivially copyable alternatives, which are copied out on access instead of referenced.
+		 */
+		static constexpr bool packed {false};
+
+		/* Position of the discriminator relative to the storage. */
+		static constexpr tag_placement placement {tag_placement::after};
+
+		/* How visit branches to the handler of the current alternative. */
+		static constexpr dispatch_strategy dispatch {dispatch_strategy::automatic};
+	};
+
+	/* Policy which enables double buffered storage. */
+	struct double_buffered_policy : variant_policy
+	{
+		static constexpr bool double_buffered {true};
+	};
+
+	/* Policy which aligns the storage to at least Alignment bytes, for example to a cache line to avoid false sharing. */
+	template <const std::size_t Alignment>
+	struct aligned_policy : variant_policy
+	{
+		static constexpr std::size_t alignment {Alignment};
+	};
+
+	/* Policy which stores the alternatives unaligned. */
+	struct packed_policy : variant_policy
+	{
+		static constexpr bool packed {true};
+	};
+
+	/* How visit resolves the handler of each alternative. */
+	enum class visit_mode
+	{
+		/* An exact handler wins over a generic one, which wins over a handler reached by implicit conversion. */
+		relaxed,
+
+		/* Like relaxed, but handlers reached by implicit conversion are rejected. */
+		strict
+	};
+
+	namespace detail
+	{
+		/* The strategy stdex::dispatch_strategy::automatic selects for N alternatives. */
+		constexpr auto select_dispatch(const std::size_t n) noexcept(true) -> dispatch_strategy
+		{
+			return n <= 3 ? dispatch_strategy::if_chain : n <= 64 ? dispatch_strategy::switch_case : dispatch_strategy::jump_table;
+		}
+
+		/* Switch over the indices [Base, Base + 16), larger ranges continue with the next block. */
+		template <typename R, const std::size_t Base, const std::size_t N, typename F>
+		inline auto dispatch_switch(const std::size_t idx, F&& functor) -> R
+		{
+#define STDEX_DISPATCH_CASE(K) \
+			case K: \
+				if constexpr (Base + (K) < N) \
+				{ \
+					return std::invoke(std::forward<F>(functor), std::integral_constant<std::size_t, Base + (K)> { }); \
+				} \
+				else \
+				{ \
+					break; \
+				}
+
+			switch (idx - Base)
+			{
+				STDEX_DISPATCH_CASE(0)
+				STDEX_DISPATCH_CASE(1)
+				STDEX_DISPATCH_CASE(2)
+				STDEX_DISPATCH_CASE(3)
+				STDEX_DISPATCH_CASE(4)
+				STDEX_DISPATCH_CASE(5)
+				STDEX_DISPATCH_CASE(6)
+				STDEX_DISPATCH_CASE(7)
+				STDEX_DISPATCH_CASE(8)
+				STDEX_DISPATCH_CASE(9)
+				STDEX_DISPATCH_CASE(10)
+				STDEX_DISPATCH_CASE(11)
+				STDEX_DISPATCH_CASE(12)
+				STDEX_DISPATCH_CASE(13)
+				STDEX_DISPATCH_CASE(14)
+				STDEX_DISPATCH_CASE(15)
+				default:
+					break;
+			}
+
+#undef STDEX_DISPATCH_CASE
+
+			if constexpr (Base + 16 < N)
+			{
+				return dispatch_switch<R, Base + 16, N>(idx, std::forward<F>(functor));
+			}
+			else
+			{
+				/* idx is inside the range, so this is never reached. */
+				return std::invoke(std::forward<F>(functor), std::integral_constant<std::size_t, N - 1> { });
+			}
+		}
+
+		template <typename R, typename F, const std::size_t I>
+		auto dispatch_thunk(F& functor) -> R
+		{
+			return std::invoke(std::forward<F>(functor), std::integral_constant<std::size_t, I> { });
+		}
+
+		/* Calls through a table of one function pointer per index. */
+		template <typename R, typename F, std::size_t... Is>
+		inline auto dispatch_table(const std::size_t idx, F&& functor, std::index_sequence<Is...>) -> R
+		{
+			static constexpr R (*table[])(std::remove_reference_t<F>&) {&dispatch_thunk<R, F, Is>...};
+			return table[idx](functor);
+		}
+
+		/* Bisects the indices [Lo, Hi). */
+		template <typename R, const std::size_t Lo, const std::size_t Hi, typename F>
+		inline auto dispatch_binary(const std::size_t idx, F&& functor) -> R
+		{
+			if constexpr (Hi - Lo == 1)
+			{
+				return std::invoke(std::forward<F>(functor), std::integral_constant<std::size_t, Lo> { });
+			}
+			else
+			{
+				constexpr std::size_t mid {Lo + (Hi - Lo) / 2};
+				if (idx < mid)
+				{
+					return dispatch_binary<R, Lo, mid>(idx, std::forward<F>(functor));
+				}
+				return dispatch_binary<R, mid, Hi>(idx, std::forward<F>(functor));
+			}
+		}
+
+		/* Invokes the functor with std::integral_constant<std::size_t, idx> for an index in range [0, N), branching as selected by S. */
+		template <typename R, const std::size_t N, const dispatch_strategy S, typename F>
+		inline auto dispatch(const std::size_t idx, F&& functor) -> R
+		{
+			if constexpr (S == dispatch_strategy::automatic)
+			{
+				return dispatch<R, N, select_dispatch(N)>(idx, std::forward<F>(functor));
+			}
+			else if constexpr (S == dispatch_strategy::switch_case)
+			{
+				return dispatch_switch<R, 0, N>(idx, std::forward<F>(functor));
+			}
+			else if constexpr (S == dispatch_strategy::jump_table)
+			{
+				return dispatch_table<R>(idx, std::forward<F>(functor), std::make_index_sequence<N> { });
+			}
+			else if constexpr (S == dispatch_strategy::binary_search)
+			{
+				return dispatch_binary<R, 0, N>(idx, std::forward<F>(functor));
+			}
+			else
+			{
+				return dispatch_index<R, 0, N>(idx, std::forward<F>(functor));
+			}
+		}
+
+		/* Parameter of a callable with exactly one non generic parameter, else void. */
+		template <typename F, typename = void>
+		struct unique_parameter
+		{
+			using type = void;
+		};
+
+		template <typename R, typename A>
+		struct unique_parameter<R (*)(A), void>
+		{
+			using type = A;
+		};
+
+		template <typename R, typename A>
+		struct unique_parameter<R (*)(A) noexcept, void>
+		{
+			using type = A;
+		};
+
+		template <typename R, typename C, typename A>
+		struct unique_parameter<R (C::*)(A), void>
+		{
+			using type = A;
+		};
+
+		template <typename R, typename C, typename A>
+		struct unique_parameter<R (C::*)(A) const, void>
+		{
+			using type = A;
+		};
+
+		template <typename R, typename C, typename A>
+		struct unique_parameter<R (C::*)(A) noexcept, void>
+		{
+			using type = A;
+		};
+
+		template <typename R, typename C, typename A>
+		struct unique_parameter<R (C::*)(A) const noexcept, void>
+		{
+			using type = A;
+		};
+
+		template <typename F>
+		struct unique_parameter<F, std::void_t<decltype(&F::operator())>> : unique_parameter<decltype(&F::operator())> { };
+
+		/* Handler ranks, lower is better. */
+		enum class handler_rank
+		{
+			exact,
+			generic,
+			converting,
+			none
+		};
+
+		/* Ranks the handler F for the alternative argument A. */
+		template <const visit_mode Mode, typename A, typename F>
+		constexpr auto rank_handler() noexcept(true) -> handler_rank
+		{
+			using parameter = typename unique_parameter<std::decay_t<F>>::type;
+			if constexpr (!std::is_invocable_v<F&, A>)
+			{
+				return handler_rank::none;
+			}
+			else if constexpr (std::is_void_v<parameter>)
+			{
+				return handler_rank::generic;
+			}
+			else if constexpr (std::is_same_v<std::remove_cv_t<std::remove_reference_t<parameter>>, std::remove_cv_t<std::remove_reference_t<A>>>)
+			{
+				return handler_rank::exact;
+			}
+			else
+			{
+				return Mode == visit_mode::strict ? handler_rank::none : handler_rank::converting;
+			}
+		}
+
+		/* Index of the first best ranked handler for the alternative argument A, or the handler count if there is none. */
+		template <const visit_mode Mode, typename A, typename... Fs>
+		constexpr auto select_handler() noexcept(true) -> std::size_t
+		{
+			constexpr std::array<handler_rank, sizeof...(Fs)> ranks {rank_handler<Mode, A, Fs>()...};
+			std::size_t  r {sizeof...(Fs)};
+			handler_rank best {handler_rank::none};
+			for (std::size_t i {0}; i < ranks.size(); ++i)
+			{
+				if (ranks[i] < best)
+				{
+					best = ranks[i];
+					r    = i;
+				}
+			}
+			return r;
+		}
+
+		/* Handler type at index I, no type if I is out of range, so visit drops out of overload resolution without a handler. */
+		template <const std::size_t I, typename... Fs>
+		struct handler_at { };
+
+		template <const std::size_t I, typename F, typename... Fs>
+		struct handler_at<I, F, Fs...> : handler_at<I - 1, Fs...> { };
+
+		template <typename F, typename... Fs>
+		struct handler_at<0, F, Fs...>
+		{
+			using type = F;
+		};
+
+		/* Handler resolution for a set of handlers, instantiated once per handler set and alternative. */
+		template <const visit_mode Mode, typename... Fs>
+		struct handler_set final
+		{
+			template <typename A>
+			static constexpr std::size_t index {select_handler<Mode, A, Fs...>()};
+
+			template <typename A>
+			using result = std::invoke_result_t<typename handler_at<index<A>, Fs...>::type&, A>;
+		};
+
+		/* Storage alignment of basic_variant<Policy, Ts...>. */
+		template <typename Policy, typename... Ts>
+		constexpr std::size_t storage_alignment {Policy::packed ? 1 : std::max({Policy::alignment, alignof(Ts)...})};
+
+		/* Storage extent of basic_variant<Policy, Ts...>. */
+		template <typename Policy, typename... Ts>
+		using variant_extent = storage_extent<std::max({sizeof(Ts)...}), storage_alignment<Policy, Ts...>, Policy::double_buffered>;
+
+		/* Layout of basic_variant<Policy, Ts...> with the discriminator first or last. */
+		template <const bool TagFirst, typename Policy, typename... Ts>
+		using placed_layout = layout
+		<
+			std::array<std::byte, variant_extent<Policy, Ts...>::value>,
+			typename discriminator<sizeof...(Ts)>::type,
+			storage_alignment<Policy, Ts...>,
+			TagFirst
+		>;
+
+		/* True if basic_variant<Policy, Ts...> places the discriminator first, see stdex::tag_placement. */
+		template <typename Policy, typename... Ts>
+		constexpr bool tag_first {Policy::placement == tag_placement::before};
+
+		/* Members of basic_variant<Policy, Ts...>. */
+		template <typename Policy, typename... Ts>
+		using variant_layout = placed_layout<tag_first<Policy, Ts...>, Policy, Ts...>;
+
+		/* Parameter type of a copy or move member the alternatives do not support, so the member is no copy or move member. */
+		template <const std::size_t>
+		struct disabled final
+		{
+			disabled() = delete;
+		};
+
+		/* Deletes the copy members a variant would otherwise get implicitly when the alternatives are not copyable. */
+		template <const bool Copyable>
+		struct copy_guard { };
+
+		template <>
+		struct copy_guard<false>
+		{
+			copy_guard() = default;
+			copy_guard(const copy_guard&) = delete;
+			copy_guard(copy_guard&&) = default;
+			auto operator =(const copy_guard&) -> copy_guard& = delete;
+			auto operator =(copy_guard&&) -> copy_guard& = default;
+		};
+	}
+
+	/* A cleaner and more intuitive std::variant alternative, parameterized by a policy (see stdex::variant_policy). */
+	template <typename Policy, typename... Ts>
+	class basic_variant final : private stdex::detail::variant_layout<Policy, Ts...>, private stdex::detail::copy_guard<std::conjunction_v<std::is_copy_constructible<Ts>...>>
+	{
+		friend struct stdex::detail::variant_access;
+
+	public:
+		struct detail final
+		{
+			/* Validate generic types: */
+			static_assert(sizeof...(Ts), "Type list must be above zero!");
+			static_assert(sizeof...(Ts) < std::numeric_limits<std::size_t>::max(), "Type count must <= size_t::max!");
+			static_assert(stdex::detail::monotonic_validator<Ts...>::value, "Types must be destructible objects and no arrays!");
+
+			/* The maximum size of one type in the collection. */
+			static constexpr std::size_t max_size {std::max({sizeof(Ts)...})};
+
+			/* The maximum alignment of one type in the collection. */
+			static constexpr std::size_t max_align {std::max({alignof(Ts)...})};
+
+			/* The alternatives. */
+			using types = stdex::type_list<Ts...>;
+
+			/* A normal std::variant holding the types, only instantiated where it is completed. */
+			using std_variant = std::variant<Ts...>;
+
+			/* A normal std::tuple holding the types, only instantiated where it is completed. */
+			using std_tuple = std::tuple<Ts...>;
+
+			/* First type. */
+			using first = stdex::detail::type_pack_element<0, Ts...>;
+
+			/* Last type. */
+			using last = stdex::detail::type_pack_element<sizeof...(Ts) - 1, Ts...>;
+
+			/* Type at index I. */
+			template <const std::size_t I>
+			using alternative = stdex::detail::type_pack_element<I, Ts...>;
+
+			/* True if the storage holds two buffers (see stdex::variant_policy::double_buffered). */
+			static constexpr bool double_buffered {Policy::double_buffered};
+
+			/* True if the alternatives are stored unaligned (see stdex::variant_policy::packed). */
+			static constexpr bool packed {Policy::packed};
+
+			static_assert(!packed || std::conjunction_v<std::is_trivially_copyable<Ts>...>, "Packed variants require trivially copyable alternatives!");
+			static_assert(!packed || STDEX_HAS_BUILTIN_BIT_CAST || std::conjunction_v<std::is_default_constructible<Ts>...>, "Packed variants require default constructible alternatives without __builtin_bit_cast!");
+			static_assert(!packed || !Policy::alignment, "Packed variants can not be aligned!");
+			static_assert(!(Policy::alignment & (Policy::alignment - 1)), "Alignment must be a power of two!");
+
+			/* True if the discriminator precedes the storage. */
+			static constexpr bool tag_first {stdex::detail::tag_first<Policy, Ts...>};
+
+			/* How visit branches to the current alternative, see stdex::dispatch_strategy. */
+			static constexpr dispatch_strategy dispatch {Policy::dispatch == dispatch_strategy::automatic ? stdex::detail::select_dispatch(sizeof...(Ts)) : Policy::dispatch};
+
+			/* The alignment of the storage, at least max_align unless packed. */
+			static constexpr std::size_t storage_align {stdex::detail::storage_alignment<Policy, Ts...>};
+
+			/* Storage extent, see stdex::detail::storage_extent. */
+			using extent = stdex::detail::variant_extent<Policy, Ts...>;
+
+			/* Bytes reserved for the alternatives, max_size for single buffered and about twice as much for double buffered storage. */
+			static constexpr std::size_t storage_size {extent::capacity};
+
+			/* The type used to store the data. */
+			using storage = std::array<std::byte, extent::value>;
+
+			/* Data storage and index, in the order selected by the policy. */
+			using layout = stdex::detail::variant_layout<Policy, Ts...>;
+
+			/* Direct discriminator type. */
+			using discriminator_v = typename stdex::detail::discriminator<sizeof...(Ts)>::type;
+
+			/* True if every alternative is copy or move constructible, else the variant is not copyable or movable either. */
+			static constexpr bool copyable {std::conjunction_v<std::is_copy_constructible<Ts>...>};
+			static constexpr bool movable {std::conjunction_v<std::is_move_constructible<Ts>...>};
+
+			/* Parameters of the copy and move members, which are not declared as such unless the alternatives support them. */
+			using copy_source = std::conditional_t<copyable, const basic_variant&, const stdex::detail::disabled<0>&>;
+			using move_source = std::conditional_t<movable, basic_variant&&, stdex::detail::disabled<1>&&>;
+		};
+
+		using discriminator_v = typename detail::discriminator_v;
+		using storage_v = typename detail::storage;
+		using layout_v = typename detail::layout;
+
+		/* Alternative T as returned by const accessors, a copy for packed variants. */
+		template <typename T>
+		using const_reference_v = std::conditional_t<detail::packed, T, const T&>;
+
+	private:
+		/* The blob holding the current alternative. */
+		inline auto active() noexcept(true) -> void*
+		{
+			if constexpr (detail::double_buffered)
+			{
+				return this->storage_.data() + (this->storage_.back() != std::byte {0} ? detail::extent::stride : 0);
+			}
+			else
+			{
+				return this->storage_.data();
+			}
+		}
+
+		inline auto active() const noexcept(true) -> const void*
+		{
+			return const_cast<basic_variant*>(this)->active();
+		}
+
+		/* The blob the next alternative is constructed into by double buffered variants. */
+		inline auto spare() noexcept(true) -> void*
+		{
+			return this->storage_.data() + (this->storage_.back() != std::byte {0} ? 0 : detail::extent::stride);
+		}
+
+		/* Makes the spare blob the active one. */
+		inline auto flip() noexcept(true) -> void
+		{
+			this->storage_.back() ^= std::byte {1};
+		}
+
+		template <typename T>
+		inline auto access_as() noexcept(true) -> T&
+		{
+			static_assert(!detail::packed, "Alternatives of packed variants might be misaligned and can only be accessed by value!");
+			return *static_cast<T*>(this->active());
+		}
+
+		template <typename T>
+		inline auto access_as() const noexcept(true) -> const_reference_v<T>
+		{
+			if constexpr (detail::packed)
+			{
+				return stdex::detail::load_as<T>(this->active());
+			}
+			else
+			{
+				return *static_cast<const T*>(this->active());
+			}
+		}
+
+		/* Constructs T into the blob. Packed variants construct a temporary and copy its bytes. */
+		template <typename T, typename... Args>
+		inline auto construct_into(void* const blob, Args&&...args) noexcept(std::is_nothrow_constructible_v<T, Args...>) -> void
+		{
+			if constexpr (detail::packed)
+			{
+				const T temporary (std::forward<Args>(args)...);
+				std::memcpy(blob, std::addressof(temporary), sizeof(T));
+			}
+			else
+			{
+				stdex::detail::construct<T>(blob, std::forward<Args>(args)...);
+			}
+		}
+
+		/* Copy constructs the current alternative of other into the blob. */
+		inline auto copy_into(void* const blob, const basic_variant& other) -> void
+		{
+			if constexpr (detail::packed)
+			{
+				std::memcpy(blob, other.active(), detail::max_size);
+			}
+			else
+			{
+				stdex::detail::recursive_invoker<Ts...>::dynamic_copy_construct(blob, other.active(), other.discriminator_);
+			}
+		}
+
+		/* Move constructs the current alternative of other into the blob. */
+		inline auto move_into(void* const blob, basic_variant& other) noexcept(std::conjunction_v<std::is_nothrow_move_constructible<Ts>...>) -> void
+		{
+			if constexpr (detail::packed)
+			{
+				std::memcpy(blob, other.active(), detail::max_size);
+			}
+			else
+			{
+				stdex::detail::recursive_invoker<Ts...>::dynamic_move_construct(blob, other.active(), other.discriminator_);
+			}
+		}
+
+		/* Destroys the current alternative. */
+		inline auto destroy() noexcept(true) -> void
+		{
+			if constexpr (!detail::packed)
+			{
+				stdex::detail::recursive_invoker<Ts...>::dynamic_destruct(this->active(), this->discriminator_);
+			}
+		}
+
+	public:
+		/* <<< STL Interface >>> */
+
+		constexpr basic_variant() noexcept(std::is_nothrow_constructible_v<typename detail::first>);
+
+		/*
+		 * Constructs the alternative selected for U directly from the value, see stdex::detail::select_alternative.
+		 */
+		template
+		<
+			typename U,
+			typename = std::enable_if_t
+			<
+				!std::is_same_v<std::remove_cv_t<std::remove_reference_t<U>>, basic_variant>
+				&& (stdex::detail::select_alternative<U, Ts...>() < sizeof...(Ts))
+			>
+		>
+		constexpr basic_variant(U&& value) noexcept(std::is_nothrow_constructible_v<typename detail::template alternative<stdex::detail::select_alternative<U, Ts...>()>, U>);
+
+		/* Constructs the alternative at index I in place. */
+		template <const std::size_t I, typename... Args, typename = std::enable_if_t<(I < sizeof...(Ts)) && std::is_constructible_v<typename detail::template alternative<I>, Args...>>>
+		constexpr explicit basic_variant(std::in_place_index_t<I>, Args&&...args) noexcept(std::is_nothrow_constructible_v<typename detail::template alternative<I>, Args...>);
+
+		/* Constructs the alternative T in place. */
+		template <typename T, typename... Args, typename = std::enable_if_t<std::is_constructible_v<T, Args...>>>
+		constexpr explicit basic_variant(std::in_place_type_t<T>, Args&&...args) noexcept(std::is_nothrow_constructible_v<T, Args...>);
+
+		basic_variant(typename detail::copy_source other);
+
+		basic_variant(typename detail::move_source other) noexcept(std::conjunction_v<std::is_nothrow_move_constructible<Ts>...>);
+
+		auto operator =(typename detail::copy_source other) -> basic_variant&;
+
+		auto operator =(typename detail::move_source other) noexcept(std::conjunction_v<std::is_nothrow_move_constructible<Ts>...>) -> basic_variant&;
+
+		/* Emplaces the alternative selected for U, see stdex::detail::select_alternative. */
+		template
+		<
+			typename U,
+			typename = std::enable_if_t
+			<
+				!std::is_same_v<std::remove_cv_t<std::remove_reference_t<U>>, basic_variant>
+				&& (stdex::detail::select_alternative<U, Ts...>() < sizeof...(Ts))
+			>
+		>
+		inline auto operator =(U&& value) -> basic_variant&
+		{
+			this->emplace<stdex::detail::select_alternative<U, Ts...>()>(std::forward<U>(value));
+			return *this;
+		}
+
+		~basic_variant();
+
+		[[nodiscard]]
+		constexpr auto index() const noexcept(true) -> discriminator_v
+		{
+			return this->discriminator_;
+		}
+
+		/* <<< Extensions >>> */
+
+		/* Returns the index of the specified type. */
+		template <typename T>
+		[[nodiscard]]
+		static constexpr auto index_of() noexcept(true) -> discriminator_v
+		{
+			discriminator_v r {0};
+			const auto      accumulator = [&r](const bool equ) noexcept(true)
+			{
+				r += !equ;
+				return equ;
+			};
+			(accumulator(std::is_same_v<T, Ts>) || ...);
+			return r;
+		}
+
+		/*
+		 * Returns a reference to the alternative at index I without checking the discriminator.
+		 * The behaviour is undefined if I is not the current index. Const packed variants return a copy.
+		 */
+		template <const std::size_t I>
+		[[nodiscard]]
+		inline auto get_unchecked() & noexcept(true) -> typename detail::template alternative<I>&
+		{
+			return this->access_as<typename detail::template alternative<I>>();
+		}
+
+		template <const std::size_t I>
+		[[nodiscard]]
+		inline auto get_unchecked() const & noexcept(true) -> const_reference_v<typename detail::template alternative<I>>
+		{
+			return this->access_as<typename detail::template alternative<I>>();
+		}
+
+		template <const std::size_t I>
+		[[nodiscard]]
+		inline auto get_unchecked() && noexcept(true) -> typename detail::template alternative<I>&&
+		{
+			return std::move(this->access_as<typename detail::template alternative<I>>());
+		}
+
+		/*
+		 * Returns a reference to the alternative T without checking the discriminator.
+		 * The behaviour is undefined if T is not the current type. Const packed variants return a copy.
+		 */
+		template <typename T, typename = std::enable_if_t<stdex::detail::monotonic_validator_v<T>>>
+		[[nodiscard]]
+		inline auto get_unchecked() & noexcept(true) -> T&
+		{
+			return this->access_as<T>();
+		}
+
+		template <typename T, typename = std::enable_if_t<stdex::detail::monotonic_validator_v<T>>>
+		[[nodiscard]]
+		inline auto get_unchecked() const & noexcept(true) -> const_reference_v<T>
+		{
+			return this->access_as<T>();
+		}
+
+		template <typename T, typename = std::enable_if_t<stdex::detail::monotonic_validator_v<T>>>
+		[[nodiscard]]
+		inline auto get_unchecked() && noexcept(true) -> T&&
+		{
+			return std::move(this->access_as<T>());
+		}
+
+		/*
+		 * Destroys the current alternative and constructs the alternative at index I in place.
+		 * If the constructor throws, the variant keeps its current value. Returns nothing for packed variants.
+		 */
+		template <const std::size_t I, typename... Args, typename = std::enable_if_t<(I < sizeof...(Ts)) && std::is_constructible_v<typename detail::template alternative<I>, Args...>>>
+		inline auto emplace(Args&&...args) -> std::conditional_t<detail::packed, void, typename detail::template alternative<I>&>;
+
+		/*
+		 * Destroys the current alternative and constructs the alternative T in place.
+		 * If the constructor throws, the variant keeps its current value.
+		 */
+		template <typename T, typename... Args, typename = std::enable_if_t<std::is_constructible_v<T, Args...>>>
+		inline auto emplace(Args&&...args) -> std::conditional_t<detail::packed, void, T&>
+		{
+			static_assert(index_of<T>() < sizeof...(Ts), "T is not an alternative of this variant!");
+			return this->emplace<index_of<T>()>(std::forward<Args>(args)...);
+		}
+
+		/*
+		 * Invokes the handler resolved for the current alternative.
+		 * The handler index of every alternative is computed at compile time, see stdex::visit_mode.
+		 */
+		template <const visit_mode Mode = visit_mode::relaxed, typename... Fs>
+		inline auto visit(Fs&&...handlers) & -> std::common_type_t<typename stdex::detail::handler_set<Mode, Fs...>::template result<Ts&>...>
+		{
+			using r = std::common_type_t<typename stdex::detail::handler_set<Mode, Fs...>::template result<Ts&>...>;
+			return stdex::detail::dispatch<r, sizeof...(Ts), detail::dispatch>(this->discriminator_, [&](auto i) -> r
+			{
+				using type = typename detail::template alternative<decltype(i)::value>;
+				auto& handler {std::get<stdex::detail::handler_set<Mode, Fs...>::template index<type&>>(std::forward_as_tuple(handlers...))};
+				if constexpr (detail::packed)
+				{
+					/* Handlers work on an aligned copy, which is written back afterwards. */
+					type copy {std::as_const(*this).template access_as<type>()};
+					const stdex::detail::write_back<type> guard {this->active(), copy};
+					return std::invoke(handler, copy);
+				}
+				else
+				{
+					return std::invoke(handler, this->access_as<type>());
+				}
+			});
+		}
+
+		template <const visit_mode Mode = visit_mode::relaxed, typename... Fs>
+		inline auto visit(Fs&&...handlers) const & -> std::common_type_t<typename stdex::detail::handler_set<Mode, Fs...>::template result<const Ts&>...>
+		{
+			using r = std::common_type_t<typename stdex::detail::handler_set<Mode, Fs...>::template result<const Ts&>...>;
+			return stdex::detail::dispatch<r, sizeof...(Ts), detail::dispatch>(this->discriminator_, [&](auto i) -> r
+			{
+				using type = typename detail::template alternative<decltype(i)::value>;
+				return std::invoke(std::get<stdex::detail::handler_set<Mode, Fs...>::template index<const type&>>(std::forward_as_tuple(handlers...)), this->access_as<type>());
+			});
+		}
+
+		/* Check if variant currently holds T. */
+		template <typename T, typename = std::enable_if_t<stdex::detail::monotonic_validator_v<T>>>
+		[[nodiscard]]
+		constexpr auto holds_alternative() const noexcept(true) -> bool
+		{
+			return this->discriminator_ == index_of<T>();
+		}
+
+		/* Check if variant currently holds T and if the values match. */
+		template <typename T, typename = std::enable_if_t<stdex::detail::monotonic_validator_v<T>>>
+		[[nodiscard]]
+		inline auto holds_value(T&& other) const noexcept(true) -> bool
+		{
+			return this->discriminator_ == index_of<T>() && this->access_as<T>() == other;
+		}
+
+		/* Returns optional which contains the value if T is the current type, else std::nullopt. */
+		template <typename T, typename = std::enable_if_t<stdex::detail::monotonic_validator_v<T>>>
+		[[nodiscard]]
+		inline auto get() const noexcept(true) -> std::optional<T>
+		{
+			return this->holds_alternative<T>() ? std::optional<T> {this->access_as<T>()} : std::optional<T> {std::nullopt};
+		}
+
+		/*
+		 * Returns the containing value of T if T is the current type, else the default value of T.
+		 * T must be default constructible.
+		 */
+		template <typename T, typename = std::enable_if_t<::stdex::detail::monotonic_validator_v<T> && std::is_default_constructible_v<T>>>
+		[[nodiscard]]
+		inline auto get_or_default() const noexcept(true) -> T
+		{
+			if constexpr (stdex::detail::branchless_scalar<T> && sizeof(T) <= detail::max_size)
+			{
+				return stdex::detail::select_scalar<T>(this->holds_alternative<T>(), this->active(), T { });
+			}
+			else
+			{
+				return this->holds_alternative<T>() ? this->access_as<T>() : T { };
+			}
+		}
+
+		/*
+		 *  Returns the containing value of T if T is the current type, else the a custom value of T.
+		 */
+		template <typename T, typename = std::enable_if_t<stdex::detail::monotonic_validator_v<T>>>
+		[[nodiscard]]
+		inline auto get_or_custom_value(T&& instead) const noexcept(true) -> T
+		{
+			if constexpr (stdex::detail::branchless_scalar<T> && sizeof(T) <= detail::max_size)
+			{
+				return stdex::detail::select_scalar<T>(this->holds_alternative<T>(), this->active(), instead);
+			}
+			else
+			{
+				return this->holds_alternative<T>() ? this->access_as<T>() : instead;
+			}
+		}
+
+
+		/*
+		 *  Returns the containing value of T if T is the current type, else invokes the lambda which returns a value instead.
+		 */
+		template <typename T, typename F, typename... Args, typename = std::enable_if_t<stdex::detail::monotonic_validator_v<T>>>
+		[[nodiscard]]
+		inline auto get_or_invoke(F&& functor, Args&&...args) const noexcept(true) -> T
+		{
+			static_assert(std::is_convertible_v<decltype(std::invoke(functor, std::forward<Args>()...)), T>, "Functor must return a T convertible type!");
+			return this->holds_alternative<T>() ? this->access_as<T>() : std::invoke(functor, std::forward<Args>()...);
+		}
+	};
+
+	/* stdex::variant with the default policy. */
+	template <typename... Ts>
+	using variant = basic_variant<variant_policy, Ts...>;
+
+	/* stdex::variant which never needs nothrow move constructible alternatives for assignment, see stdex::variant_policy::double_buffered. */
+	template <typename... Ts>
+	using double_buffered_variant = basic_variant<double_buffered_policy, Ts...>;
+
+	/* stdex::variant with storage aligned to at least Alignment bytes, see stdex::variant_policy::alignment. */
+	template <const std::size_t Alignment, typename... Ts>
+	using variant_aligned = basic_variant<aligned_policy<Alignment>, Ts...>;
+
+	/* stdex::variant with unaligned storage, see stdex::variant_policy::packed. */
+	template <typename... Ts>
+	using packed_variant = basic_variant<packed_policy, Ts...>;
+
+	namespace detail
+	{
+		template <typename... Ty>
+		struct recursive_invoker;
+
+		template <typename T, typename... Ty>
+		struct recursive_invoker<T, Ty...> final
+		{
+			using mapping = variant<T, Ty...>;
+
+			/* The index is relative to T, every recursion step strips one type of the list. */
+			template <typename... Ctor>
+			static inline auto dynamic_construct(void* const blob, const typename mapping::discriminator_v idx, Ctor&&...ctor) noexcept(std::is_nothrow_constructible_v<T, Ctor...>) -> void
+			{
+				if (idx == 0)
+				{
+					construct<T>(blob, std::forward<Ctor>(ctor)...);
+				}
+				else
+				{
+					recursive_invoker<Ty...>::dynamic_construct(blob, idx - 1, std::forward<Ctor>(ctor)...);
+				}
+			}
+
+			static inline auto dynamic_destruct(void* const blob, const typename mapping::discriminator_v idx) noexcept(std::is_nothrow_destructible_v<T>) -> void
+			{
+				if (idx == 0)
+				{
+					destruct<T>(blob);
+				}
+				else
+				{
+					recursive_invoker<Ty...>::dynamic_destruct(blob, idx - 1);
+				}
+			}
+
+			static inline auto dynamic_copy_construct(void* const blob, const void* const source, const typename mapping::discriminator_v idx) -> void
+			{
+				if (idx == 0)
+				{
+					construct<T>(blob, *static_cast<const T*>(source));
+				}
+				else
+				{
+					recursive_invoker<Ty...>::dynamic_copy_construct(blob, source, idx - 1);
+				}
+			}
+
+			static inline auto dynamic_move_construct(void* const blob, void* const source, const typename mapping::discriminator_v idx) noexcept(std::conjunction_v<std::is_nothrow_move_constructible<T>, std::is_nothrow_move_constructible<Ty>...>) -> void
+			{
+				if (idx == 0)
+				{
+					construct<T>(blob, std::move(*static_cast<T*>(source)));
+				}
+				else
+				{
+					recursive_invoker<Ty...>::dynamic_move_construct(blob, source, idx - 1);
+				}
+			}
+		};
+
+		template <>
+		struct recursive_invoker<> final
+		{
+			template <typename... Ctor>
+			static inline auto dynamic_construct(void* const, const std::size_t, Ctor&&...) noexcept(true) -> void { }
+
+			static inline auto dynamic_destruct(void* const, const std::size_t) noexcept(true) -> void { }
+
+			static inline auto dynamic_copy_construct(void* const, const void* const, const std::size_t) noexcept(true) -> void { }
+
+			static inline auto dynamic_move_construct(void* const, void* const, const std::size_t) noexcept(true) -> void { }
+		};
+	}
+
+	template <typename Policy, typename... Ts>
+	constexpr basic_variant<Policy, Ts...>::basic_variant() noexcept(std::is_nothrow_constructible_v<typename detail::first>) : layout_v {0}
+	{
+		static_assert(std::is_default_constructible_v<typename detail::first>, "Default constructor requires the first element to be default constructible!");
+		if constexpr (!std::is_scalar_v<typename detail::first>)
+		{
+			this->construct_into<typename detail::first>(this->active());
+		}
+	}
+
+	template <typename Policy, typename... Ts>
+	template <typename U, typename>
+	constexpr basic_variant<Policy, Ts...>::basic_variant(U&& value) noexcept(std::is_nothrow_constructible_v<typename detail::template alternative<stdex::detail::select_alternative<U, Ts...>()>, U>) : layout_v {static_cast<discriminator_v>(stdex::detail::select_alternative<U, Ts...>())}
+	{
+		this->construct_into<typename detail::template alternative<stdex::detail::select_alternative<U, Ts...>()>>(this->active(), std::forward<U>(value));
+	}
+
+	template <typename Policy, typename... Ts>
+	template <const std::size_t I, typename... Args, typename>
+	constexpr basic_variant<Policy, Ts...>::basic_variant(std::in_place_index_t<I>, Args&&...args) noexcept(std::is_nothrow_constructible_v<typename detail::template alternative<I>, Args...>) : layout_v {static_cast<discriminator_v>(I)}
+	{
+		this->construct_into<typename detail::template alternative<I>>(this->active(), std::forward<Args>(args)...);
+	}
+
+	template <typename Policy, typename... Ts>
+	template <typename T, typename... Args, typename>
+	constexpr basic_variant<Policy, Ts...>::basic_variant(std::in_place_type_t<T>, Args&&...args) noexcept(std::is_nothrow_constructible_v<T, Args...>) : basic_variant {std::in_place_index<index_of<T>()>, std::forward<Args>(args)...}
+	{
+		static_assert(index_of<T>() < sizeof...(Ts), "T is not an alternative of this variant!");
+	}
+
+	template <typename Policy, typename... Ts>
+	basic_variant<Policy, Ts...>::basic_variant(typename detail::copy_source other) : layout_v {other.discriminator_}
+	{
+		this->copy_into(this->active(), other);
+	}
+
+	template <typename Policy, typename... Ts>
+	basic_variant<Policy, Ts...>::basic_variant(typename detail::move_source other) noexcept(std::conjunction_v<std::is_nothrow_move_constructible<Ts>...>) : layout_v {other.discriminator_}
+	{
+		this->move_into(this->active(), other);
+	}
+
+	template <typename Policy, typename... Ts>
+	auto basic_variant<Policy, Ts...>::operator =(typename detail::copy_source other) -> basic_variant&
+	{
+		if (this != std::addressof(other))
+		{
+			if constexpr (detail::double_buffered)
+			{
+				this->copy_into(this->spare(), other);
+				this->destroy();
+				this->flip();
+				this->discriminator_ = other.discriminator_;
+			}
+			else
+			{
+				/* Copy first, so a throwing copy constructor leaves this variant untouched. */
+				*this = basic_variant {other};
+			}
+		}
+		return *this;
+	}
+
+	template <typename Policy, typename... Ts>
+	auto basic_variant<Policy, Ts...>::operator =(typename detail::move_source other) noexcept(std::conjunction_v<std::is_nothrow_move_constructible<Ts>...>) -> basic_variant&
+	{
+		if (this != std::addressof(other))
+		{
+			if constexpr (detail::double_buffered)
+			{
+				this->move_into(this->spare(), other);
+				this->destroy();
+				this->flip();
+			}
+			else
+			{
+				static_assert(std::conjunction_v<std::is_nothrow_move_constructible<Ts>...>, "Assignment requires nothrow move constructible alternatives, use stdex::double_buffered_policy instead!");
+				this->destroy();
+				this->move_into(this->active(), other);
+			}
+			this->discriminator_ = other.discriminator_;
+		}
+		return *this;
+	}
+
+	template <typename Policy, typename... Ts>
+	basic_variant<Policy, Ts...>::~basic_variant()
+	{
+		this->destroy();
+	}
+
+	template <typename Policy, typename... Ts>
+	template <const std::size_t I, typename... Args, typename>
+	inline auto basic_variant<Policy, Ts...>::emplace(Args&&...args) -> std::conditional_t<detail::packed, void, typename detail::template alternative<I>&>
+	{
+		using type = typename detail::template alternative<I>;
+		if constexpr (detail::double_buffered)
+		{
+			this->construct_into<type>(this->spare(), std::forward<Args>(args)...);
+			this->destroy();
+			this->flip();
+		}
+		else if constexpr (std::is_nothrow_constructible_v<type, Args...>)
+		{
+			this->destroy();
+			this->construct_into<type>(this->active(), std::forward<Args>(args)...);
+		}
+		else
+		{
+			static_assert(std::is_nothrow_move_constructible_v<type>, "Emplacing requires a nothrow constructor or a nothrow move constructor, use stdex::double_buffered_policy instead!");
+			type temporary (std::forward<Args>(args)...);
+			this->destroy();
+			this->construct_into<type>(this->active(), std::move(temporary));
+		}
+		this->discriminator_ = static_cast<discriminator_v>(I);
+		if constexpr (!detail::packed)
+		{
+			return this->access_as<type>();
+		}
+	}
+
+	/* Variants compare equal if they hold the same alternative and the values compare equal. */
+	template <typename Policy, typename... Ts>
+	[[nodiscard]]
+	auto operator ==(const basic_variant<Policy, Ts...>& lhs, const basic_variant<Policy, Ts...>& rhs) -> bool
+	{
+		return lhs.index() == rhs.index() && stdex::detail::dispatch_index<bool, 0, sizeof...(Ts)>(lhs.index(), [&](auto i) -> bool
+		{
+			return lhs.template get_unchecked<decltype(i)::value>() == rhs.template get_unchecked<decltype(i)::value>();
+		});
+	}
+
+	template <typename Policy, typename... Ts>
+	[[nodiscard]]
+	inline auto operator !=(const basic_variant<Policy, Ts...>& lhs, const basic_variant<Policy, Ts...>& rhs) -> bool
+	{
+		return !(lhs == rhs);
+	}
+
+	namespace detail
+	{
+		/* Hashes only the current alternative with std::hash, the index is left to the caller. */
+		template <typename Policy, typename... Ts>
+		auto hash_alternative(const basic_variant<Policy, Ts...>& value) -> std::size_t
+		{
+			return stdex::detail::dispatch_index<std::size_t, 0, sizeof...(Ts)>(value.index(), [&](auto i) -> std::size_t
+			{
+				using type = typename basic_variant<Policy, Ts...>::detail::template alternative<decltype(i)::value>;
+				return std::hash<type> { }(value.template get_unchecked<decltype(i)::value>());
+			});
+		}
+
+		/* Spreads the entropy of a hash over all bits (splitmix64 finalizer). */
+		constexpr auto mix_hash(std::uint64_t x) noexcept(true) -> std::uint64_t
+		{
+			x ^= x >> 30;
+			x *= 0xBF58476D1CE4E5B9;
+			x ^= x >> 27;
+			x *= 0x94D049BB133111EB;
+			return x ^ x >> 31;
+		}
+	}
+
+	namespace detail
+	{
+		/* Sentinel of stdex::detail::index_remap for alternatives missing in the target. */
+		inline constexpr std::size_t unmapped {std::numeric_limits<std::size_t>::max()};
+
+		/* Maps every alternative index of Source to the index of the same type in Target. */
+		template <typename Source, typename Target>
+		struct index_remap;
+
+		template <typename SourcePolicy, typename... Ss, typename TargetPolicy, typename... Ts>
+		struct index_remap<basic_variant<SourcePolicy, Ss...>, basic_variant<TargetPolicy, Ts...>> final
+		{
+			static constexpr std::array<std::size_t, sizeof...(Ss)> value
+			{
+				(stdex::detail::index_of_type<Ss, Ts...>() < sizeof...(Ts) ? stdex::detail::index_of_type<Ss, Ts...>() : unmapped)...
+			};
+
+			static constexpr bool total {((stdex::detail::index_of_type<Ss, Ts...>() < sizeof...(Ts)) && ...)};
+
+			/* Bytes of every alternative of Source. */
+			static constexpr std::array<std::size_t, sizeof...(Ss)> sizes {sizeof(Ss)...};
+
+			/* Trivially copyable alternatives are relocated by copying their bytes, without dispatching on the type. */
+			static constexpr bool bytewise
+			{
+				std::conjunction_v<std::is_trivially_copyable<Ss>..., std::is_trivially_copyable<Ts>...>
+				&& std::is_nothrow_default_constructible_v<basic_variant<TargetPolicy, Ts...>>
+			};
+		};
+
+		struct variant_access final
+		{
+			/* Converts source into Target, the current alternative of source must be mapped. */
+			template <typename Target, typename Source>
+			static auto relocate(Source&& source) -> Target
+			{
+				using mapping = std::remove_cv_t<std::remove_reference_t<Source>>;
+				using remap   = index_remap<mapping, Target>;
+				const std::size_t from {source.index()};
+				if constexpr (remap::bytewise)
+				{
+					Target r { };
+					std::memcpy(r.active(), source.active(), remap::sizes[from]);
+					r.discriminator_ = static_cast<typename Target::discriminator_v>(remap::value[from]);
+					return r;
+				}
+				else
+				{
+					return dispatch_index<Target, 0, remap::value.size()>(from, [&](auto i) -> Target
+					{
+						constexpr std::size_t to {remap::value[decltype(i)::value]};
+						if constexpr (to == unmapped)
+						{
+							std::terminate();
+						}
+						else
+						{
+							return Target {std::in_place_index<to>, std::forward<Source>(source).template get_unchecked<decltype(i)::value>()};
+						}
+					});
+				}
+			}
+		};
+	}
+
+	/*
+	 * Converts the variant into Target, which must contain every alternative of the variant.
+	 * The target alternative is looked up in a table computed at compile time.
+	 */
+	template <typename Target, typename Source>
+	[[nodiscard]]
+	inline auto widen(Source&& source) -> Target
+	{
+		static_assert(stdex::detail::index_remap<std::remove_cv_t<std::remove_reference_t<Source>>, Target>::total, "Target must contain every alternative of the source variant!");
+		return stdex::detail::variant_access::relocate<Target>(std::forward<Source>(source));
+	}
+
+	/*
+	 * Converts the variant into Target if Target contains the current alternative, else returns std::nullopt.
+	 * The target alternative is looked up in a table computed at compile time.
+	 */
+	template <typename Target, typename Source>
+	[[nodiscard]]
+	inline auto narrow(Source&& source) -> std::optional<Target>
+	{
+		using remap = stdex::detail::index_remap<std::remove_cv_t<std::remove_reference_t<Source>>, Target>;
+		if (remap::value[source.index()] == stdex::detail::unmapped)
+		{
+			return std::nullopt;
+		}
+		return stdex::detail::variant_access::relocate<Target>(std::forward<Source>(source));
+	}
+
+	namespace detail
+	{
+		template <typename T>
+		struct is_variant final : std::false_type { };
+
+		template <typename Policy, typename... Ts>
+		struct is_variant<basic_variant<Policy, Ts...>> final : std::true_type { };
+
+		/* The alternatives T contributes to a flattened variant, T itself unless it is a variant. */
+		template <typename T>
+		struct nested_alternatives final
+		{
+			static constexpr std::size_t count {1};
+
+			template <typename List>
+			using append_to = typename type_list_append_unique<List, T>::type;
+
+			template <const std::size_t>
+			using at = T;
+		};
+
+		template <typename Policy, typename... Us>
+		struct nested_alternatives<basic_variant<Policy, Us...>> final
+		{
+			static constexpr std::size_t count {sizeof...(Us)};
+
+			template <typename List>
+			using append_to = typename type_list_append_unique<List, Us...>::type;
+
+			template <const std::size_t J>
+			using at = type_pack_element<J, Us...>;
+		};
+
+		template <typename List, typename... Ts>
+		struct flat_collect final
+		{
+			using type = List;
+		};
+
+		template <typename List, typename T, typename... Ts>
+		struct flat_collect<List, T, Ts...> final
+		{
+			using type = typename flat_collect<typename nested_alternatives<T>::template append_to<List>, Ts...>::type;
+		};
+
+		template <typename Policy, typename List>
+		struct flat_variant;
+
+		template <typename Policy, typename... Ts>
+		struct flat_variant<Policy, type_list<Ts...>> final
+		{
+			using type = basic_variant<Policy, Ts...>;
+		};
+
+		/*
+		 * Numbers every alternative of the inner variants of V, and every other alternative of V, with a slot.
+		 * Each slot maps to one alternative of the flattened variant at compile time.
+		 */
+		template <typename V>
+		struct nested_slots;
+
+		template <typename Policy, typename... Os>
+		struct nested_slots<basic_variant<Policy, Os...>> final
+		{
+			static_assert(!Policy::packed, "Nested alternatives of packed variants can not be accessed in place!");
+
+			using mapping = basic_variant<Policy, Os...>;
+			using flat    = typename flat_variant<Policy, typename flat_collect<type_list<>, Os...>::type>::type;
+
+			/* First slot of every alternative of V. */
+			static constexpr std::array<std::size_t, sizeof...(Os)> offsets {[]
+			{
+				constexpr std::array<std::size_t, sizeof...(Os)> widths {nested_alternatives<Os>::count...};
+				std::array<std::size_t, sizeof...(Os)>           r { };
+				std::size_t                                      offset {0};
+				for (std::size_t i {0}; i < sizeof...(Os); ++i)
+				{
+					r[i] = offset;
+					offset += widths[i];
+				}
+				return r;
+			}()};
+
+			static constexpr std::size_t count {(nested_alternatives<Os>::count + ...)};
+
+			/* Alternative of V owning the slot. */
+			static constexpr auto outer(const std::size_t slot) noexcept(true) -> std::size_t
+			{
+				std::size_t i {0};
+				while (i + 1 < sizeof...(Os) && offsets[i + 1] <= slot)
+				{
+					++i;
+				}
+				return i;
+			}
+
+			template <const std::size_t L>
+			using outer_type = typename mapping::detail::template alternative<outer(L)>;
+
+			/* Type of the slot. */
+			template <const std::size_t L>
+			using leaf = typename nested_alternatives<outer_type<L>>::template at<L - offsets[outer(L)]>;
+
+			/* Index of the slot in the flattened variant. */
+			template <const std::size_t L>
+			static constexpr std::size_t flat_index {flat::template index_of<leaf<L>>()};
+
+			/*
+			 * Slot of the current alternative. The discriminator of a nested variant sits at a different offset for every outer alternative,
+			 * so this branches on the outer discriminator first and then only loads the inner one.
+			 */
+			static auto slot_of(const mapping& nested) noexcept(true) -> std::size_t
+			{
+				return dispatch<std::size_t, sizeof...(Os), mapping::detail::dispatch>(nested.index(), [&](auto i) -> std::size_t
+				{
+					if constexpr (is_variant<typename mapping::detail::template alternative<decltype(i)::value>>::value)
+					{
+						return offsets[decltype(i)::value] + nested.template get_unchecked<decltype(i)::value>().index();
+					}
+					else
+					{
+						return offsets[decltype(i)::value];
+					}
+				});
+			}
+
+			/* Accesses the slot L, which must be the current slot. */
+			template <const std::size_t L, typename W>
+			static auto access(W&& nested) noexcept(true) -> decltype(auto)
+			{
+				if constexpr (is_variant<outer_type<L>>::value)
+				{
+					return std::forward<W>(nested).template get_unchecked<outer(L)>().template get_unchecked<L - offsets[outer(L)]>();
+				}
+				else
+				{
+					return std::forward<W>(nested).template get_unchecked<outer(L)>();
+				}
+			}
+		};
+
+		/* Result of visiting the alternatives of the flattened variant F with handlers Fs, as const lvalues if Const. */
+		template <const visit_mode Mode, const bool Const, typename F, typename... Fs>
+		struct flat_visit_result;
+
+		template <const visit_mode Mode, const bool Const, typename Policy, typename... Ts, typename... Fs>
+		struct flat_visit_result<Mode, Const, basic_variant<Policy, Ts...>, Fs...> final
+		{
+			using type = std::common_type_t<typename handler_set<Mode, Fs...>::template result<std::conditional_t<Const, const Ts&, Ts&>>...>;
+		};
+	}
+
+	/* The variant V with every alternative which is a variant replaced by its alternatives, without duplicates. */
+	template <typename V>
+	using flatten_t = typename stdex::detail::nested_slots<V>::flat;
+
+	/* Converts a variant of variants into the flattened variant, the target index is looked up in a table computed at compile time. */
+	template <typename V>
+	[[nodiscard]]
+	inline auto flatten(V&& nested) -> flatten_t<std::remove_cv_t<std::remove_reference_t<V>>>
+	{
+		using slots = stdex::detail::nested_slots<std::remove_cv_t<std::remove_reference_t<V>>>;
+		using flat  = typename slots::flat;
+		return stdex::detail::dispatch_index<flat, 0, slots::count>(slots::slot_of(nested), [&](auto l) -> flat
+		{
+			return flat {std::in_place_index<slots::template flat_index<decltype(l)::value>>, slots::template access<decltype(l)::value>(std::forward<V>(nested))};
+		});
+	}
+
+	/*
+	 * Visits a variant of variants as if it was flattened, see stdex::flatten_t.
+	 * The current slot is computed from both discriminators, branching on the outer one, and then dispatched once to the handler
+	 * resolved for the flattened alternative. Unlike visiting the outer and then the inner variant, handlers see leaves only.
+	 */
+	template <const visit_mode Mode = visit_mode::relaxed, typename V, typename... Fs, typename = std::enable_if_t<stdex::detail::is_variant<std::remove_const_t<V>>::value>>
+	inline auto visit_flat(V& nested, Fs&&...handlers) -> typename stdex::detail::flat_visit_result<Mode, std::is_const_v<V>, flatten_t<std::remove_const_t<V>>, Fs...>::type
+	{
+		using slots = stdex::detail::nested_slots<std::remove_const_t<V>>;
+		using r     = typename stdex::detail::flat_visit_result<Mode, std::is_const_v<V>, typename slots::flat, Fs...>::type;
+		return stdex::detail::dispatch_index<r, 0, slots::count>(slots::slot_of(nested), [&](auto l) -> r
+		{
+			using type = std::conditional_t<std::is_const_v<V>, const typename slots::template leaf<decltype(l)::value>&, typename slots::template leaf<decltype(l)::value>&>;
+			return std::invoke(std::get<stdex::detail::handler_set<Mode, Fs...>::template index<type>>(std::forward_as_tuple(handlers...)), slots::template access<decltype(l)::value>(nested));
+		});
+	}
+
+	/* Memory footprint of a variant type with N alternatives, see stdex::layout_report. */
+	template <const std::size_t N>
+	struct variant_layout_report final
+	{
+		/* sizeof and alignof of the variant. */
+		std::size_t size;
+		std::size_t alignment;
+
+		/* Bytes of the storage holding the alternatives. */
+		std::size_t payload_size;
+
+		/* Bytes of the discriminator. */
+		std::size_t tag_size;
+
+		/* Bytes neither used by the storage nor by the discriminator. */
+		std::size_t padding;
+
+		/* Bytes of the variant unused while alternative i is active. */
+		std::array<std::size_t, N> wasted;
+
+		/* Storage bytes saved if alternative i was stored behind a pointer. */
+		std::array<std::size_t, N> boxing_savings;
+
+		/* True if boxing alternative i at least halves the storage. */
+		std::array<bool, N> boxing_candidates;
+	};
+
+	namespace detail
+	{
+		template <typename V>
+		struct layout_reporter;
+
+		template <typename Policy, typename... Ts>
+		struct layout_reporter<basic_variant<Policy, Ts...>> final
+		{
+			using mapping = basic_variant<Policy, Ts...>;
+
+			static constexpr auto report() noexcept(true) -> variant_layout_report<sizeof...(Ts)>
+			{
+				constexpr std::array<std::size_t, sizeof...(Ts)> sizes {sizeof(Ts)...};
+				variant_layout_report<sizeof...(Ts)> r { };
+				r.size         = sizeof(mapping);
+				r.alignment    = alignof(mapping);
+				r.payload_size = sizeof(typename mapping::storage_v);
+				r.tag_size     = sizeof(typename mapping::discriminator_v);
+				r.padding      = r.size - r.payload_size - r.tag_size;
+				for (std::size_t i {0}; i < sizeof...(Ts); ++i)
+				{
+					std::size_t boxed_max {sizeof(void*)};
+					for (std::size_t j {0}; j < sizeof...(Ts); ++j)
+					{
+						boxed_max = i == j ? boxed_max : std::max(boxed_max, sizes[j]);
+					}
+					r.wasted[i]            = r.size - sizes[i];
+					r.boxing_savings[i]    = boxed_max < mapping::detail::max_size ? mapping::detail::max_size - boxed_max : 0;
+					r.boxing_candidates[i] = r.boxing_savings[i] * 2 >= mapping::detail::max_size;
+				}
+				return r;
+			}
+		};
+	}
+
+	/* Returns the memory footprint of the variant type V at compile time. */
+	template <typename V>
+	[[nodiscard]]
+	constexpr auto layout_report() noexcept(true)
+	{
+		return detail::layout_reporter<V>::report();
+	}
+
+	namespace detail
+	{
+		/* The reducer of alternative I, a single reducer is shared by all alternatives. */
+		template <const std::size_t I, typename... Fs>
+		inline auto reducer_at(Fs&...reducers) noexcept(true) -> auto&
+		{
+			if constexpr (sizeof...(Fs) == 1)
+			{
+				return (reducers, ...);
+			}
+			else
+			{
+				return std::get<I>(std::forward_as_tuple(reducers...));
+			}
+		}
+
+		/*
+		 * Folds [first, last) into the accumulators.
+		 * The discriminator is dispatched once per run of equal tags, the run itself is folded without dispatching.
+		 */
+		template <typename It, typename Accs, typename... Fs>
+		inline auto fold_runs(It first, const It last, Accs& accumulators, Fs&...reducers) -> void
+		{
+			using mapping = std::remove_cv_t<std::remove_reference_t<decltype(*first)>>;
+			constexpr std::size_t count {mapping::detail::types::size};
+			static_assert(std::tuple_size_v<Accs> == count, "One accumulator per alternative is required!");
+			static_assert(sizeof...(Fs) == 1 || sizeof...(Fs) == count, "Either one reducer per alternative or a single reducer is required!");
+			while (first != last)
+			{
+				const auto tag {first->index()};
+				It         end {std::next(first)};
+				while (end != last && end->index() == tag)
+				{
+					++end;
+				}
+				stdex::detail::dispatch_index<void, 0, count>(tag, [&](auto i) -> void
+				{
+					auto& reducer {reducer_at<decltype(i)::value>(reducers...)};
+					auto& accumulator {std::get<decltype(i)::value>(accumulators)};
+					for (; first != end; ++first)
+					{
+						accumulator = std::invoke(reducer, std::move(accumulator), std::as_const(*first).template get_unchecked<decltype(i)::value>());
+					}
+				});
+			}
+		}
+	}
+
+	/*
+	 * Reduces a range of variants into one accumulator per alternative, starting with init.
+	 * Reducers are invoked as acc = reducer(std::move(acc), value), either one per alternative or a single one for all.
+	 */
+	template <typename Range, typename... Accs, typename... Fs>
+	[[nodiscard]]
+	inline auto fold_by_type(Range&& range, std::tuple<Accs...> init, Fs&&...reducers) -> std::tuple<Accs...>
+	{
+		stdex::detail::fold_runs(std::begin(range), std::end(range), init, reducers...);
+		return init;
+	}
+
+	namespace detail
+	{
+		/* Detects contiguous containers through data(). */
+		template <typename C, typename = void>
+		struct is_contiguous final : std::false_type { };
+
+		template <typename C>
+		struct is_contiguous<C, std::void_t<decltype(std::declval<C&>().data())>> final : std::true_type { };
+
+		/*
+		 * Elements which can be relocated as bytes. basic_variant declares its copy and move members even for trivially copyable
+		 * alternatives, so it is not trivially copyable itself and is relocated by move assignment.
+		 */
+		template <typename V>
+		struct is_byte_relocatable final : std::is_trivially_copyable<V> { };
+
+		/*
+		 * Removes all elements whose alternative index is not marked in keep, preserving the order of the rest.
+		 * Only discriminators are inspected, and every run of kept elements is relocated as a whole.
+		 */
+		template <typename C, const std::size_t N>
+		inline auto compact_alternatives(C& container, const std::array<bool, N>& keep) -> std::size_t
+		{
+			using mapping = typename C::value_type;
+			const auto kept = [&keep](const mapping& value) noexcept(true)
+			{
+				return keep[value.index()];
+			};
+			const auto last {std::end(container)};
+			auto       out {std::find_if_not(std::begin(container), last, kept)};
+			for (auto i {out}; i != last;)
+			{
+				i = std::find_if(i, last, kept);
+				const auto run {std::find_if_not(i, last, kept)};
+				if constexpr (is_contiguous<C>::value && is_byte_relocatable<mapping>::value)
+				{
+					const auto count {static_cast<std::size_t>(run - i)};
+					if (count != 0)
+					{
+						std::memmove(static_cast<void*>(std::addressof(*out)), std::addressof(*i), count * sizeof(mapping));
+					}
+					out += static_cast<std::ptrdiff_t>(count);
+				}
+				else
+				{
+					out = std::move(i, run, out);
+				}
+				i = run;
+			}
+			const auto removed {static_cast<std::size_t>(std::distance(out, last))};
+			container.erase(out, last);
+			return removed;
+		}
+
+		template <typename V, typename... Ts>
+		struct alternative_mask;
+
+		template <typename Policy, typename... Us, typename... Ts>
+		struct alternative_mask<basic_variant<Policy, Us...>, Ts...> final
+		{
+			static constexpr std::array<bool, sizeof...(Us)> value {(stdex::detail::index_of_type<Us, Ts...>() < sizeof...(Ts))...};
+		};
+	}
+
+	/* Removes all elements holding the alternative T from a container of variants, preserving order. Returns the number removed. */
+	template <typename T, typename C>
+	inline auto erase_alternative(C& container) -> std::size_t
+	{
+		auto keep {stdex::detail::alternative_mask<typename C::value_type, T>::value};
+		static_assert(C::value_type::template index_of<T>() < std::tuple_size_v<decltype(keep)>, "T is not an alternative of this variant!");
+		for (auto& k : keep)
+		{
+			k = !k;
+		}
+		return stdex::detail::compact_alternatives(container, keep);
+	}
+
+	/* Removes all elements not holding one of the alternatives Ts from a container of variants, preserving order. Returns the number removed. */
+	template <typename... Ts, typename C>
+	inline auto keep_alternatives(C& container) -> std::size_t
+	{
+		static_assert(((C::value_type::template index_of<Ts>() < C::value_type::detail::types::size) && ...), "Ts must be alternatives of this variant!");
+		return stdex::detail::compact_alternatives(container, stdex::detail::alternative_mask<typename C::value_type, Ts...>::value);
+	}
+
+	/*
+	 * Writes get_or_custom_value<T>(instead) of every variant in the range to out, one T per element.
+	 * Scalars are selected without branching, so unpredictable alternatives cause no mispredictions
+	 * and compilers can vectorize the loop.
+	 */
+	template <typename T, typename Range, typename Out>
+	inline auto get_or_custom_value_column(const Range& range, Out out, const T& instead) -> Out
+	{
+		for (const auto& value : range)
+		{
+			*out = value.template get_or_custom_value<T>(T {instead});
+			++out;
+		}
+		return out;
+	}
+
+	/* Writes get_or_default<T>() of every variant in the range to out, one T per element. */
+	template <typename T, typename Range, typename Out>
+	inline auto get_or_default_column(const Range& range, Out out) -> Out
+	{
+		return stdex::get_or_custom_value_column<T>(range, out, T { });
+	}
+
+	/*
+	 * Extracts the alternative T of a range of variants into a dense column in one pass.
+	 * out_values receives every T in order and needs room for one T per variant, out_mask receives one bit per variant,
+	 * set if it holds T, in words of 64 bits. Returns the number of values extracted.
+	 * Scalars are stored unconditionally and the column advances by the tag compare, so the loop has no data dependent branches.
+	 */
+	template <typename T, typename Range>
+	inline auto extract(const Range& variants, T* const out_values, std::uint64_t* const out_mask) -> std::size_t
+	{
+		std::size_t   count {0};
+		std::size_t   i {0};
+		std::uint64_t word {0};
+		for (const auto& value : variants)
+		{
+			using mapping = std::remove_cv_t<std::remove_reference_t<decltype(value)>>;
+			static_assert(mapping::template index_of<T>() < mapping::detail::types::size, "T is not an alternative of this variant!");
+			const bool holds {value.template holds_alternative<T>()};
+			if constexpr (stdex::detail::branchless_scalar<T>)
+			{
+				out_values[count] = value.template get_or_default<T>();
+				count += holds;
+			}
+			else if (holds)
+			{
+				out_values[count++] = value.template get_unchecked<T>();
+			}
+			word |= static_cast<std::uint64_t>(holds) << (i % 64);
+			if (++i % 64 == 0)
+			{
+				out_mask[i / 64 - 1] = word;
+				word = 0;
+			}
+		}
+		if (i % 64 != 0)
+		{
+			out_mask[i / 64] = word;
+		}
+		return count;
+	}
+
+	namespace detail
+	{
+		/* Predicate of an unguarded clause. */
+		struct always final
+		{
+			template <typename T>
+			constexpr auto operator ()(const T&) const noexcept(true) -> bool
+			{
+				return true;
+			}
+		};
+
+		/* Handles the alternative T if the predicate returns true. */
+		template <typename T, typename P, typename H>
+		struct clause final
+		{
+			using type = T;
+
+			P predicate;
+			H handler;
+		};
+
+		/* Handles every value not handled by a clause. */
+		template <typename H>
+		struct fallback final
+		{
+			H handler;
+		};
+
+		/* Type guard of a clause, created by stdex::when. */
+		template <typename T, typename P>
+		struct guard final
+		{
+			P predicate;
+
+			template <typename H>
+			constexpr auto operator >>(H&& handler) && -> clause<T, P, std::decay_t<H>>
+			{
+				return {std::move(this->predicate), std::forward<H>(handler)};
+			}
+		};
+
+		/* Type of stdex::otherwise. */
+		struct otherwise_t final
+		{
+			template <typename H>
+			constexpr auto operator >>(H&& handler) const -> fallback<std::decay_t<H>>
+			{
+				return {std::forward<H>(handler)};
+			}
+		};
+
+		template <typename T>
+		struct is_fallback final : std::false_type { };
+
+		template <typename H>
+		struct is_fallback<fallback<H>> final : std::true_type { };
+
+		/* Result type of a clause handler, Const is true when matching a const variant. */
+		template <const bool Const, typename C>
+		struct clause_result final
+		{
+			using type = std::invoke_result_t<decltype(C::handler)&, std::conditional_t<Const, const typename C::type&, typename C::type&>>;
+		};
+
+		template <const bool Const, typename H>
+		struct clause_result<Const, fallback<H>> final
+		{
+			using type = std::invoke_result_t<H&>;
+		};
+
+		/* True if the clause is a fallback or matches an alternative of the variant V. */
+		template <typename V, typename C>
+		constexpr auto is_clause_of() noexcept(true) -> bool
+		{
+			if constexpr (is_fallback<C>::value)
+			{
+				return true;
+			}
+			else
+			{
+				return V::template index_of<typename C::type>() < V::detail::types::size;
+			}
+		}
+
+		/*
+		 * Evaluates the clauses from K on, which handle the alternative V, in order.
+		 * Clauses of other alternatives are dropped at compile time, a fallback ends the chain.
+		 */
+		template <typename R, const std::size_t K, typename V, typename... Cs>
+		inline auto match_clauses(V& value, std::tuple<Cs...>& clauses) -> R
+		{
+			if constexpr (K == sizeof...(Cs))
+			{
+				static_assert(std::is_void_v<R>, "Non void matches require a stdex::otherwise clause!");
+			}
+			else
+			{
+				using clause_v = typename stdex::type_list<Cs...>::template at<K>;
+				auto& c {std::get<K>(clauses)};
+				if constexpr (is_fallback<clause_v>::value)
+				{
+					return std::invoke(c.handler);
+				}
+				else
+				{
+					if constexpr (std::is_same_v<typename clause_v::type, std::remove_const_t<V>>)
+					{
+						if (std::invoke(c.predicate, std::as_const(value)))
+						{
+							return std::invoke(c.handler, value);
+						}
+					}
+					return match_clauses<R, K + 1>(value, clauses);
+				}
+			}
+		}
+
+		/* Holds the variant to match, created by stdex::match. */
+		template <typename V>
+		class matcher final
+		{
+			V& variant_;
+
+		public:
+			constexpr explicit matcher(V& variant) noexcept(true) : variant_ {variant} { }
+
+			/*
+			 * Dispatches once on the discriminator, then evaluates only the guards of the active alternative in order.
+			 * Handlers receive the alternative, the handler of stdex::otherwise receives nothing.
+			 */
+			template <typename... Cs>
+			inline auto operator ()(Cs&&...clauses) -> std::common_type_t<typename clause_result<std::is_const_v<V>, std::decay_t<Cs>>::type...>
+			{
+				using r = std::common_type_t<typename clause_result<std::is_const_v<V>, std::decay_t<Cs>>::type...>;
+				using detail = typename std::remove_const_t<V>::detail;
+				static_assert((is_clause_of<std::remove_const_t<V>, std::decay_t<Cs>>() && ...), "Clause type is not an alternative of the variant!");
+				std::tuple<std::decay_t<Cs>...> list {std::forward<Cs>(clauses)...};
+				return dispatch_index<r, 0, detail::types::size>(this->variant_.index(), [this, &list](auto i) -> r
+				{
+					return match_clauses<r, 0>(this->variant_.template get_unchecked<decltype(i)::value>(), list);
+				});
+			}
+		};
+	}
+
+	/* Starts a clause matching the alternative T if the predicate returns true. */
+	template <typename T, typename P>
+	constexpr auto when(P&& predicate) -> detail::guard<T, std::decay_t<P>>
+	{
+		return {std::forward<P>(predicate)};
+	}
+
+	/* Starts a clause matching the alternative T. */
+	template <typename T>
+	constexpr auto when() noexcept(true) -> detail::guard<T, detail::always>
+	{
+		return { };
+	}
+
+	/* Starts the clause matching everything not matched before. */
+	inline constexpr detail::otherwise_t otherwise { };
+
+	/* Matches the variant against clauses: stdex::match(v)(stdex::when<T>(pred) >> handler, stdex::otherwise >> fallback). */
+	template <typename Policy, typename... Ts>
+	constexpr auto match(basic_variant<Policy, Ts...>& variant) noexcept(true) -> detail::matcher<basic_variant<Policy, Ts...>>
+	{
+		return detail::matcher<basic_variant<Policy, Ts...>> {variant};
+	}
+
+	template <typename Policy, typename... Ts>
+	constexpr auto match(const basic_variant<Policy, Ts...>& variant) noexcept(true) -> detail::matcher<const basic_variant<Policy, Ts...>>
+	{
+		return detail::matcher<const basic_variant<Policy, Ts...>> {variant};
+	}
+
+	/* Wraps an error value, used to construct a result holding an error. */
+	template <typename E>
+	class unexpected final
+	{
+		static_assert(stdex::detail::monotonic_validator_v<E>, "Error type must be a destructible object and no array!");
+
+	private:
+		E error_;
+
+	public:
+		template <typename... Args, typename = std::enable_if_t<std::is_constructible_v<E, Args...>>>
+		constexpr explicit unexpected(std::in_place_t, Args&&...args) noexcept(std::is_nothrow_constructible_v<E, Args...>) : error_ {std::forward<Args>(args)...} { }
+
+		constexpr explicit unexpected(E error) noexcept(std::is_nothrow_move_constructible_v<E>) : error_ {std::move(error)} { }
+
+		[[nodiscard]]
+		constexpr auto error() & noexcept(true) -> E&
+		{
+			return this->error_;
+		}
+
+		[[nodiscard]]
+		constexpr auto error() const & noexcept(true) -> const E&
+		{
+			return this->error_;
+		}
+
+		[[nodiscard]]
+		constexpr auto error() && noexcept(true) -> E&&
+		{
+			return std::move(this->error_);
+		}
+	};
+
+	template <typename E>
+	unexpected(E) -> unexpected<E>;
+
+	template <typename T, typename... Es>
+	class result;
+
+	namespace detail
+	{
+		template <typename T>
+		struct is_unexpected final : std::false_type { };
+
+		template <typename E>
+		struct is_unexpected<unexpected<E>> final : std::true_type { };
+
+		template <typename T>
+		struct is_result final : std::false_type { };
+
+		template <typename T, typename... Es>
+		struct is_result<result<T, Es...>> final : std::true_type { };
+	}
+
+	/*
+	 * Holds either a value of T or one of the errors Es, without using exceptions.
+	 * The value and the errors share the storage and the discriminator of a stdex::variant<T, Es...>,
+	 * where the value is always at index 0 and the errors follow in order.
+	 */
+	template <typename T, typename... Es>
+	class [[nodiscard]] result final
+	{
+	public:
+		struct detail final
+		{
+			static_assert(sizeof...(Es), "Error type list must be above zero!");
+
+			/* The underlying variant. */
+			using storage = variant<T, Es...>;
+
+			/* First error type. */
+			using first_error = typename storage::detail::template alternative<1>;
+
+			/* Returns the discriminator index of the error E. Errors are looked up separately, so E may be the same type as T. */
+			template <typename E>
+			[[nodiscard]]
+			static constexpr auto error_index() noexcept(true) -> std::size_t
+			{
+				return static_cast<std::size_t>(variant<Es...>::template index_of<E>()) + 1;
+			}
+		};
+
+		using value_type = T;
+		using discriminator_v = typename detail::storage::discriminator_v;
+
+	private:
+		/* Value or error. */
+		typename detail::storage variant_;
+
+		template <typename R>
+		inline auto propagate_error() const & -> R
+		{
+			return stdex::detail::dispatch_index<R, 1, sizeof...(Es) + 1>(this->variant_.index(), [this](auto i)
+			{
+				return R {std::in_place_index<decltype(i)::value>, this->variant_.template get_unchecked<decltype(i)::value>()};
+			});
+		}
+
+		template <typename R>
+		inline auto propagate_error() && -> R
+		{
+			return stdex::detail::dispatch_index<R, 1, sizeof...(Es) + 1>(this->variant_.index(), [this](auto i)
+			{
+				return R {std::in_place_index<decltype(i)::value>, std::move(this->variant_).template get_unchecked<decltype(i)::value>()};
+			});
+		}
+
+	public:
+		/* Constructs a result holding a value. */
+		template
+		<
+			typename U = T,
+			typename = std::enable_if_t
+			<
+				std::is_constructible_v<T, U>
+				&& !std::is_same_v<std::remove_cv_t<std::remove_reference_t<U>>, result>
+				&& !stdex::detail::is_unexpected<std::remove_cv_t<std::remove_reference_t<U>>>::value
+			>
+		>
+		constexpr result(U&& value) noexcept(std::is_nothrow_constructible_v<T, U>) : variant_ {std::in_place_index<0>, std::forward<U>(value)} { }
+
+		/* Constructs a result holding the error E. */
+		template <typename E, typename = std::enable_if_t<(detail::template error_index<E>() <= sizeof...(Es))>>
+		constexpr result(unexpected<E>&& error) noexcept(std::is_nothrow_move_constructible_v<E>) : variant_ {std::in_place_index<detail::template error_index<E>()>, std::move(error).error()} { }
+
+		template <typename E, typename = std::enable_if_t<(detail::template error_index<E>() <= sizeof...(Es))>>
+		constexpr result(const unexpected<E>& error) noexcept(std::is_nothrow_copy_constructible_v<E>) : variant_ {std::in_place_index<detail::template error_index<E>()>, error.error()} { }
+
+		/* Constructs the value (I == 0) or the error (I > 0) at discriminator index I in place. */
+		template <const std::size_t I, typename... Args>
+		constexpr explicit result(std::in_place_index_t<I>, Args&&...args) noexcept(std::is_nothrow_constructible_v<typename detail::storage::detail::template alternative<I>, Args...>) : variant_ {std::in_place_index<I>, std::forward<Args>(args)...} { }
+
+		[[nodiscard]]
+		constexpr auto index() const noexcept(true) -> discriminator_v
+		{
+			return this->variant_.index();
+		}
+
+		[[nodiscard]]
+		constexpr auto has_value() const noexcept(true) -> bool
+		{
+			return this->variant_.index() == 0;
+		}
+
+		[[nodiscard]]
+		constexpr explicit operator bool() const noexcept(true)
+		{
+			return this->has_value();
+		}
+
+		/* Check if the result currently holds the error E. */
+		template <typename E>
+		[[nodiscard]]
+		constexpr auto holds_error() const noexcept(true) -> bool
+		{
+			return this->variant_.index() == detail::template error_index<E>();
+		}
+
+		/* Returns the value. The behaviour is undefined if the result holds an error. */
+		[[nodiscard]]
+		inline auto value() & noexcept(true) -> T&
+		{
+			return this->variant_.template get_unchecked<0>();
+		}
+
+		[[nodiscard]]
+		inline auto value() const & noexcept(true) -> const T&
+		{
+			return this->variant_.template get_unchecked<0>();
+		}
+
+		[[nodiscard]]
+		inline auto value() && noexcept(true) -> T&&
+		{
+			return std::move(this->variant_).template get_unchecked<0>();
+		}
+
+		/* Returns the value if present, else the custom value. */
+		template <typename U>
+		[[nodiscard]]
+		inline auto value_or(U&& instead) const & -> T
+		{
+			return this->has_value() ? this->value() : static_cast<T>(std::forward<U>(instead));
+		}
+
+		template <typename U>
+		[[nodiscard]]
+		inline auto value_or(U&& instead) && -> T
+		{
+			return this->has_value() ? std::move(*this).value() : static_cast<T>(std::forward<U>(instead));
+		}
+
+		/* Returns the error E. The behaviour is undefined if the result does not hold E. */
+		template <typename E = typename detail::first_error>
+		[[nodiscard]]
+		inline auto error() & noexcept(true) -> E&
+		{
+			return this->variant_.template get_unchecked<detail::template error_index<E>()>();
+		}
+
+		template <typename E = typename detail::first_error>
+		[[nodiscard]]
+		inline auto error() const & noexcept(true) -> const E&
+		{
+			return this->variant_.template get_unchecked<detail::template error_index<E>()>();
+		}
+
+		template <typename E = typename detail::first_error>
+		[[nodiscard]]
+		inline auto error() && noexcept(true) -> E&&
+		{
+			return std::move(this->variant_).template get_unchecked<detail::template error_index<E>()>();
+		}
+
+		/*
+		 * Invokes the functor with the value, which must return a result with the same error types.
+		 * Errors are propagated unchanged.
+		 */
+		template <typename F>
+		inline auto and_then(F&& functor) const & -> std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<F, const T&>>>
+		{
+			using r = std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<F, const T&>>>;
+			static_assert(stdex::detail::is_result<r>::value, "Functor must return a stdex::result!");
+			return this->has_value() ? std::invoke(std::forward<F>(functor), this->value()) : this->template propagate_error<r>();
+		}
+
+		template <typename F>
+		inline auto and_then(F&& functor) && -> std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<F, T&&>>>
+		{
+			using r = std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<F, T&&>>>;
+			static_assert(stdex::detail::is_result<r>::value, "Functor must return a stdex::result!");
+			return this->has_value() ? std::invoke(std::forward<F>(functor), std::move(*this).value()) : std::move(*this).template propagate_error<r>();
+		}
+
+		/* Maps the value with the functor into a new result. Errors are propagated unchanged. */
+		template <typename F>
+		inline auto transform(F&& functor) const & -> result<std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<F, const T&>>>, Es...>
+		{
+			using r = result<std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<F, const T&>>>, Es...>;
+			return this->has_value() ? r {std::in_place_index<0>, std::invoke(std::forward<F>(functor), this->value())} : this->template propagate_error<r>();
+		}
+
+		template <typename F>
+		inline auto transform(F&& functor) && -> result<std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<F, T&&>>>, Es...>
+		{
+			using r = result<std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<F, T&&>>>, Es...>;
+			return this->has_value() ? r {std::in_place_index<0>, std::invoke(std::forward<F>(functor), std::move(*this).value())} : std::move(*this).template propagate_error<r>();
+		}
+
+		/*
+		 * Invokes the functor with the active error, which must return a result with the same value type.
+		 * The functor must accept every error type. A value is propagated unchanged.
+		 */
+		template <typename F>
+		inline auto or_else(F&& functor) const & -> std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<F, const typename detail::first_error&>>>
+		{
+			using r = std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<F, const typename detail::first_error&>>>;
+			static_assert(stdex::detail::is_result<r>::value, "Functor must return a stdex::result!");
+			if (this->has_value())
+			{
+				return r {std::in_place_index<0>, this->value()};
+			}
+			return stdex::detail::dispatch_index<r, 1, sizeof...(Es) + 1>(this->variant_.index(), [this, &functor](auto i) -> r
+			{
+				return std::invoke(std::forward<F>(functor), this->variant_.template get_unchecked<decltype(i)::value>());
+			});
+		}
+
+		template <typename F>
+		inline auto or_else(F&& functor) && -> std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<F, typename detail::first_error&&>>>
+		{
+			using r = std::remove_cv_t<std::remove_reference_t<std::invoke_result_t<F, typename detail::first_error&&>>>;
+			static_assert(stdex::detail::is_result<r>::value, "Functor must return a stdex::result!");
+			if (this->has_value())
+			{
+				return r {std::in_place_index<0>, std::move(*this).value()};
+			}
+			return stdex::detail::dispatch_index<r, 1, sizeof...(Es) + 1>(this->variant_.index(), [this, &functor](auto i) -> r
+			{
+				return std::invoke(std::forward<F>(functor), std::move(this->variant_).template get_unchecked<decltype(i)::value>());
+			});
+		}
+	};
+
+	/* A result with exactly one error type. */
+	template <typename T, typename E>
+	using expected = result<T, E>;
+
+	namespace detail
+	{
+		/* Type erased operations of an stdex::open_variant alternative. */
+		struct open_vtable final
+		{
+			/* Destroys the object in place. */
+			void (*destroy)(void*) noexcept;
+
+			/* Copy constructs the source object into the blob, nullptr for types which are not copy constructible. */
+			void (*copy_construct)(void*, const void*);
+
+			/* Move constructs the source object into the blob, only used for nothrow move constructible types. */
+			void (*move_construct)(void*, void*) noexcept;
+
+			/* Copies the object onto the heap, nullptr for types which are not copy constructible. */
+			void* (*box_copy)(const void*);
+
+			/* Deletes an object created on the heap. */
+			void (*box_delete)(void*) noexcept;
+		};
+
+		template <typename T>
+		struct open_operations final
+		{
+			static auto destroy(void* const blob) noexcept(true) -> void
+			{
+				stdex::detail::destruct<T>(blob);
+			}
+
+			static auto copy_construct(void* const blob, const void* const source) -> void
+			{
+				if constexpr (std::is_copy_constructible_v<T>)
+				{
+					stdex::detail::construct<T>(blob, *static_cast<const T*>(source));
+				}
+			}
+
+			static auto move_construct(void* const blob, void* const source) noexcept(true) -> void
+			{
+				stdex::detail::construct<T>(blob, std::move(*static_cast<T*>(source)));
+			}
+
+			static auto box_copy(const void* const source) -> void*
+			{
+				if constexpr (std::is_copy_constructible_v<T>)
+				{
+					return new T(*static_cast<const T*>(source));
+				}
+				else
+				{
+					return nullptr;
+				}
+			}
+
+			static auto box_delete(void* const object) noexcept(true) -> void
+			{
+				delete static_cast<T*>(object);
+			}
+		};
+
+		template <typename T>
+		constexpr open_vtable open_vtable_v
+		{
+			&open_operations<T>::destroy,
+			std::is_copy_constructible_v<T> ? &open_operations<T>::copy_construct : nullptr,
+			&open_operations<T>::move_construct,
+			std::is_copy_constructible_v<T> ? &open_operations<T>::box_copy : nullptr,
+			&open_operations<T>::box_delete
+		};
+	}
+
+	/*
+	 * Runtime registry assigning compact ids to the alternatives of stdex::open_variant.
+	 * Ids start at 1 in order of first use and index the table of type erased operations.
+	 * Registration is lock free, exceeding STDEX_TYPE_REGISTRY_CAPACITY terminates.
+	 */
+	class type_registry final
+	{
+	public:
+		using id_type = std::uint32_t;
+
+		static constexpr id_type capacity {STDEX_TYPE_REGISTRY_CAPACITY};
+
+		/* Returns the id of T, registering T on first use. */
+		template <typename T>
+		[[nodiscard]]
+		static inline auto id() noexcept(true) -> id_type
+		{
+			static_assert(std::is_same_v<T, std::decay_t<T>> && stdex::detail::monotonic_validator_v<T>, "Types must be decayed, destructible objects and no arrays!");
+			static const id_type id {[]
+			{
+				const id_type r {add(&stdex::detail::open_vtable_v<T>)};
+				registered<T>().store(r, std::memory_order_release);
+				return r;
+			}()};
+			return id;
+		}
+
+		/* Returns the id of T without registering it, zero if T was never registered. */
+		template <typename T>
+		[[nodiscard]]
+		static inline auto find() noexcept(true) -> id_type
+		{
+			return registered<T>().load(std::memory_order_acquire);
+		}
+
+		/* Returns the operations of a registered id. */
+		[[nodiscard]]
+		static inline auto table(const id_type id) noexcept(true) -> const stdex::detail::open_vtable&
+		{
+			return *entries()[id];
+		}
+
+		/* Returns the number of registered types. */
+		[[nodiscard]]
+		static inline auto size() noexcept(true) -> id_type
+		{
+			return std::min(count().load(std::memory_order_acquire), capacity);
+		}
+
+	private:
+		template <typename T>
+		static inline auto registered() noexcept(true) -> std::atomic<id_type>&
+		{
+			static std::atomic<id_type> id {0};
+			return id;
+		}
+
+		static inline auto entries() noexcept(true) -> std::array<const stdex::detail::open_vtable*, capacity + 1>&
+		{
+			static std::array<const stdex::detail::open_vtable*, capacity + 1> tables { };
+			return tables;
+		}
+
+		static inline auto count() noexcept(true) -> std::atomic<id_type>&
+		{
+			static std::atomic<id_type> registered {0};
+			return registered;
+		}
+
+		static inline auto add(const stdex::detail::open_vtable* const table) noexcept(true) -> id_type
+		{
+			const id_type id {count().fetch_add(1, std::memory_order_acq_rel) + 1};
+			if (id > capacity)
+			{
+				std::terminate();
+			}
+			entries()[id] = table;
+			return id;
+		}
+	};
+
+	/*
+	 * A variant over an open set of types, registered at runtime in stdex::type_registry.
+	 * Types up to InlineBytes with nothrow move constructors are stored inline, larger ones on the heap.
+	 * Unlike stdex::variant it can be empty, which is also the default.
+	 * Move only alternatives are supported, but copying a variant holding one terminates, as the type is only known at runtime.
+	 */
+	template <const std::size_t InlineBytes = 3 * sizeof(void*)>
+	class open_variant final
+	{
+	public:
+		struct detail final
+		{
+			static_assert(InlineBytes >= sizeof(void*), "Inline storage must at least hold a pointer!");
+
+			/* True if T is stored inline instead of on the heap. */
+			template <typename T>
+			static constexpr bool stored_inline {sizeof(T) <= InlineBytes && alignof(T) <= alignof(std::max_align_t) && std::is_nothrow_move_constructible_v<T>};
+
+			/* The type used to store the data. */
+			using storage = std::array<std::byte, InlineBytes>;
+		};
+
+		using id_type = typename type_registry::id_type;
+
+	private:
+		/* Inline object or pointer to the boxed object. */
+		alignas(std::max_align_t) typename detail::storage storage_;
+
+		/* Type id shifted left by one, the low bit is set for boxed objects. Zero if empty. */
+		id_type tag_;
+
+		[[nodiscard]]
+		inline auto boxed() const noexcept(true) -> bool
+		{
+			return this->tag_ & 1;
+		}
+
+		[[nodiscard]]
+		inline auto box() const noexcept(true) -> void*
+		{
+			void* object;
+			std::memcpy(&object, this->storage_.data(), sizeof(void*));
+			return object;
+		}
+
+		inline auto set_box(void* const object) noexcept(true) -> void
+		{
+			std::memcpy(this->storage_.data(), &object, sizeof(void*));
+		}
+
+		[[nodiscard]]
+		inline auto object() noexcept(true) -> void*
+		{
+			return this->boxed() ? this->box() : this->storage_.data();
+		}
+
+		[[nodiscard]]
+		inline auto object() const noexcept(true) -> const void*
+		{
+			return this->boxed() ? this->box() : this->storage_.data();
+		}
+
+		inline auto copy_from(const open_variant& other) -> void
+		{
+			if (other.tag_)
+			{
+				const auto& table {type_registry::table(other.tag_ >> 1)};
+				if (!table.copy_construct)
+				{
+					std::terminate();
+				}
+				if (other.boxed())
+				{
+					this->set_box(table.box_copy(other.box()));
+				}
+				else
+				{
+					table.copy_construct(this->storage_.data(), other.storage_.data());
+				}
+			}
+			this->tag_ = other.tag_;
+		}
+
+		inline auto move_from(open_variant& other) noexcept(true) -> void
+		{
+			if (other.tag_ && !other.boxed())
+			{
+				const auto& table {type_registry::table(other.tag_ >> 1)};
+				table.move_construct(this->storage_.data(), other.storage_.data());
+				table.destroy(other.storage_.data());
+			}
+			else
+			{
+				this->storage_ = other.storage_;
+			}
+			this->tag_  = other.tag_;
+			other.tag_ = 0;
+		}
+
+	public:
+		constexpr open_variant() noexcept(true) : storage_ { }, tag_ {0} { }
+
+		/* Constructs the alternative std::decay_t<T> from the value. */
+		template
+		<
+			typename T,
+			typename = std::enable_if_t
+			<
+				!std::is_same_v<std::decay_t<T>, open_variant>
+				&& !stdex::detail::is_variant<std::decay_t<T>>::value
+				&& std::is_constructible_v<std::decay_t<T>, T>
+			>
+		>
+		open_variant(T&& value) : storage_ { }, tag_ {0}
+		{
+			this->emplace<std::decay_t<T>>(std::forward<T>(value));
+		}
+
+		/* Constructs the alternative T in place. */
+		template <typename T, typename... Args, typename = std::enable_if_t<std::is_constructible_v<T, Args...>>>
+		explicit open_variant(std::in_place_type_t<T>, Args&&...args) : storage_ { }, tag_ {0}
+		{
+			this->emplace<T>(std::forward<Args>(args)...);
+		}
+
+		/* Converts a closed variant, dispatching once on its discriminator. */
+		template <typename Policy, typename... Ts>
+		open_variant(const basic_variant<Policy, Ts...>& other) : storage_ { }, tag_ {0}
+		{
+			stdex::detail::dispatch_index<void, 0, sizeof...(Ts)>(other.index(), [this, &other](auto i)
+			{
+				this->emplace<typename basic_variant<Policy, Ts...>::detail::template alternative<decltype(i)::value>>(other.template get_unchecked<decltype(i)::value>());
+			});
+		}
+
+		template <typename Policy, typename... Ts>
+		open_variant(basic_variant<Policy, Ts...>&& other) : storage_ { }, tag_ {0}
+		{
+			stdex::detail::dispatch_index<void, 0, sizeof...(Ts)>(other.index(), [this, &other](auto i)
+			{
+				this->emplace<typename basic_variant<Policy, Ts...>::detail::template alternative<decltype(i)::value>>(std::move(other).template get_unchecked<decltype(i)::value>());
+			});
+		}
+
+		open_variant(const open_variant& other) : storage_ { }, tag_ {0}
+		{
+			this->copy_from(other);
+		}
+
+		open_variant(open_variant&& other) noexcept(true) : storage_ { }, tag_ {0}
+		{
+			this->move_from(other);
+		}
+
+		inline auto operator =(const open_variant& other) -> open_variant&
+		{
+			if (this != std::addressof(other))
+			{
+				/* Copy first, so a throwing copy constructor leaves this variant untouched. */
+				*this = open_variant {other};
+			}
+			return *this;
+		}
+
+		inline auto operator =(open_variant&& other) noexcept(true) -> open_variant&
+		{
+			if (this != std::addressof(other))
+			{
+				this->reset();
+				this->move_from(other);
+			}
+			return *this;
+		}
+
+		~open_variant()
+		{
+			this->reset();
+		}
+
+		/* Destroys the current alternative, leaving the variant empty. */
+		inline auto reset() noexcept(true) -> void
+		{
+			if (this->tag_)
+			{
+				const auto& table {type_registry::table(this->tag_ >> 1)};
+				if (this->boxed())
+				{
+					table.box_delete(this->box());
+				}
+				else
+				{
+					table.destroy(this->storage_.data());
+				}
+				this->tag_ = 0;
+			}
+		}
+
+		/*
+		 * Destroys the current alternative and constructs T in place.
+		 * If the constructor throws, the variant is left empty.
+		 */
+		template <typename T, typename... Args, typename = std::enable_if_t<std::is_constructible_v<T, Args...>>>
+		inline auto emplace(Args&&...args) -> T&
+		{
+			this->reset();
+			if constexpr (detail::template stored_inline<T>)
+			{
+				stdex::detail::construct<T>(this->storage_.data(), std::forward<Args>(args)...);
+				this->tag_ = type_registry::id<T>() << 1;
+			}
+			else
+			{
+				this->set_box(new T(std::forward<Args>(args)...));
+				this->tag_ = type_registry::id<T>() << 1 | 1;
+			}
+			return *static_cast<T*>(this->object());
+		}
+
+		[[nodiscard]]
+		inline auto has_value() const noexcept(true) -> bool
+		{
+			return this->tag_ != 0;
+		}
+
+		/* Returns the type id of the current alternative, zero if empty. */
+		[[nodiscard]]
+		inline auto type_id() const noexcept(true) -> id_type
+		{
+			return this->tag_ >> 1;
+		}
+
+		/* Check if variant currently holds T. */
+		template <typename T>
+		[[nodiscard]]
+		inline auto holds_alternative() const noexcept(true) -> bool
+		{
+			/* A type which was never registered can not be held, so looking it up must not register it. */
+			const id_type id {type_registry::find<T>()};
+			return id != 0 && this->tag_ >> 1 == id;
+		}
+
+		/* Returns a pointer to the alternative T if it is the current type, else nullptr. */
+		template <typename T>
+		[[nodiscard]]
+		inline auto get_if() noexcept(true) -> T*
+		{
+			return this->holds_alternative<T>() ? static_cast<T*>(this->object()) : nullptr;
+		}
+
+		template <typename T>
+		[[nodiscard]]
+		inline auto get_if() const noexcept(true) -> const T*
+		{
+			return this->holds_alternative<T>() ? static_cast<const T*>(this->object()) : nullptr;
+		}
+
+		/* Returns optional which contains the value if T is the current type, else std::nullopt. */
+		template <typename T>
+		[[nodiscard]]
+		inline auto get() const -> std::optional<T>
+		{
+			return this->holds_alternative<T>() ? std::optional<T> {*static_cast<const T*>(this->object())} : std::optional<T> {std::nullopt};
+		}
+
+		/*
+		 * Returns a reference to the alternative T without checking the type id.
+		 * The behaviour is undefined if T is not the current type.
+		 */
+		template <typename T>
+		[[nodiscard]]
+		inline auto get_unchecked() noexcept(true) -> T&
+		{
+			return *static_cast<T*>(this->object());
+		}
+
+		template <typename T>
+		[[nodiscard]]
+		inline auto get_unchecked() const noexcept(true) -> const T&
+		{
+			return *static_cast<const T*>(this->object());
+		}
+	};
+}
+
+namespace std
+{
+	/* Hashes the index and the current alternative of the variant. */
+	template <typename Policy, typename... Ts>
+	struct hash<stdex::basic_variant<Policy, Ts...>>
+	{
+		auto operator ()(const stdex::basic_variant<Policy, Ts...>& value) const -> std::size_t;
+	};
+
+	template <typename Policy, typename... Ts>
+	auto hash<stdex::basic_variant<Policy, Ts...>>::operator ()(const stdex::basic_variant<Policy, Ts...>& value) const -> std::size_t
+	{
+		return static_cast<std::size_t>(stdex::detail::mix_hash(stdex::detail::hash_alternative(value) + value.index()));
+	}
+}
+
+/*
+ * Explicit instantiation of the out-of-line kernels of stdex::basic_variant<Policy, ...>:
+ * destruction, copying, moving, comparison and hashing.
+ * STDEX_BASIC_VARIANT_EXTERN, usually next to the message type definitions, keeps every including translation unit
+ * from instantiating them, STDEX_BASIC_VARIANT_INSTANTIATE provides them in exactly one translation unit.
+ * Both must be used at global scope, and every alternative must be default constructible first, copyable, equality comparable and hashable.
+ * Single buffered variants also need nothrow move constructible alternatives, as their move assignment is instantiated too.
+ */
+#define STDEX_BASIC_VARIANT_EXTERN(Policy, ...) \
+	extern template class stdex::basic_variant<Policy, __VA_ARGS__>; \
+	extern template auto stdex::operator ==(const stdex::basic_variant<Policy, __VA_ARGS__>&, const stdex::basic_variant<Policy, __VA_ARGS__>&) -> bool; \
+	extern template auto stdex::detail::hash_alternative(const stdex::basic_variant<Policy, __VA_ARGS__>&) -> std::size_t; \
+	extern template struct std::hash<stdex::basic_variant<Policy, __VA_ARGS__>>
+
+#define STDEX_BASIC_VARIANT_INSTANTIATE(Policy, ...) \
+	template class stdex::basic_variant<Policy, __VA_ARGS__>; \
+	template auto stdex::operator ==(const stdex::basic_variant<Policy, __VA_ARGS__>&, const stdex::basic_variant<Policy, __VA_ARGS__>&) -> bool; \
+	template auto stdex::detail::hash_alternative(const stdex::basic_variant<Policy, __VA_ARGS__>&) -> std::size_t; \
+	template struct std::hash<stdex::basic_variant<Policy, __VA_ARGS__>>
+
+/* STDEX_BASIC_VARIANT_EXTERN and STDEX_BASIC_VARIANT_INSTANTIATE for stdex::variant<...>. */
+#define STDEX_VARIANT_EXTERN(...) STDEX_BASIC_VARIANT_EXTERN(stdex::variant_policy, __VA_ARGS__)
+#define STDEX_VARIANT_INSTANTIATE(...) STDEX_BASIC_VARIANT_INSTANTIATE(stdex::variant_policy, __VA_ARGS__)
 
 #endif
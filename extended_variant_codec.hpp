@@ -0,0 +1,589 @@
+/*
+	MIT License
+
+	Copyright 2021 Mario Sieg "pinsrq" <mt3000@gmx.de>
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+ */
+
+/*
+ * The binary encoding of variants: stdex::encode and stdex::decode for single values,
+ * stdex::serialize_batch and stdex::deserialize_batch for ranges grouped into one block per alternative.
+ */
+
+#ifndef EXTENDED_VARIANT_CODEC_HPP
+#define EXTENDED_VARIANT_CODEC_HPP
+
+#include "extended_variant.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace stdex
+{
+	/*
+	 * Stable id of a type in the binary encoding, specialize it to keep encoded variants readable after alternatives are reordered:
+	 * template <> struct stdex::type_id<login> : std::integral_constant<std::uint32_t, 1> { };
+	 * Either all or none of the alternatives of a variant have an id. Without ids, the discriminator is encoded.
+	 */
+	template <typename T>
+	struct type_id;
+
+	template <typename T>
+	inline constexpr std::uint32_t type_id_v {type_id<T>::value};
+
+	/*
+	 * Encodes and decodes the payload of T. Trivially copyable types are copied bytewise and std::basic_string<char> stores its characters,
+	 * specialize it for other alternatives with:
+	 * static auto size(const T& value) -> std::size_t;
+	 * static auto write(std::byte* out, const T& value) -> void;                        // writes exactly size(value) bytes
+	 * static auto read(const std::byte* first, std::size_t size) -> std::optional<T>;
+	 */
+	template <typename T, typename = void>
+	struct value_codec final
+	{
+		static_assert(std::is_trivially_copyable_v<T>, "Type has no stdex::value_codec specialization!");
+
+		/* Payloads of the same size are stored without length by stdex::serialize_batch. */
+		static constexpr std::size_t fixed_size {sizeof(T)};
+
+		static constexpr auto size(const T&) noexcept(true) -> std::size_t
+		{
+			return sizeof(T);
+		}
+
+		static inline auto write(std::byte* const out, const T& value) noexcept(true) -> void
+		{
+			std::memcpy(out, &value, sizeof(T));
+		}
+
+		static inline auto read(const std::byte* const first, const std::size_t size) noexcept(true) -> std::optional<T>
+		{
+			if (size != sizeof(T))
+			{
+				return std::nullopt;
+			}
+			return stdex::detail::load_as<T>(first);
+		}
+	};
+
+	template <typename Traits, typename Allocator>
+	struct value_codec<std::basic_string<char, Traits, Allocator>> final
+	{
+		using string = std::basic_string<char, Traits, Allocator>;
+
+		static inline auto size(const string& value) noexcept(true) -> std::size_t
+		{
+			return value.size();
+		}
+
+		static inline auto write(std::byte* const out, const string& value) noexcept(true) -> void
+		{
+			std::memcpy(out, value.data(), value.size());
+		}
+
+		static inline auto read(const std::byte* const first, const std::size_t size) -> std::optional<string>
+		{
+			return string {reinterpret_cast<const char*>(first), size};
+		}
+	};
+
+	/* Reasons for stdex::decode to fail. */
+	enum class decode_errc : std::uint8_t
+	{
+		truncated,
+		unknown_id,
+		invalid_payload
+	};
+
+	namespace detail
+	{
+		template <typename T, typename = void>
+		struct has_type_id final : std::false_type { };
+
+		template <typename T>
+		struct has_type_id<T, std::void_t<decltype(type_id<T>::value)>> final : std::true_type { };
+
+		/* Appends the value as LEB128. */
+		inline auto write_varint(std::vector<std::byte>& out, std::uint64_t value) -> void
+		{
+			while (value >= 0x80)
+			{
+				out.push_back(static_cast<std::byte>(value | 0x80));
+				value >>= 7;
+			}
+			out.push_back(static_cast<std::byte>(value));
+		}
+
+		/* Reads a LEB128 value and advances first, returns false if the input ends first or the value overflows. */
+		inline auto read_varint(const std::byte*& first, const std::byte* const last, std::uint64_t& value) noexcept(true) -> bool
+		{
+			value = 0;
+			for (unsigned shift {0}; first != last && shift < 64; shift += 7)
+			{
+				const auto b {std::to_integer<std::uint64_t>(*first++)};
+				if (shift == 63 && b > 1)
+				{
+					/* The tenth byte only has room for bit 63. */
+					return false;
+				}
+				value |= (b & 0x7F) << shift;
+				if (b < 0x80)
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		/*
+		 * Maps the stable ids of Ts to their discriminator with a table searched at compile time:
+		 * the slot of an id is the high bits of id * seed, the smallest table and seed without collisions are chosen.
+		 */
+		template <typename... Ts>
+		struct stable_ids final
+		{
+			static constexpr std::size_t count {sizeof...(Ts)};
+			static constexpr std::array<std::uint32_t, count> ids {type_id_v<Ts>...};
+
+			struct layout final
+			{
+				unsigned      bits;
+				std::uint64_t seed;
+			};
+
+			static constexpr auto slot(const std::uint32_t id, const layout l) noexcept(true) -> std::size_t
+			{
+				return static_cast<std::size_t>((id * l.seed & 0xFFFFFFFF) >> (32 - l.bits));
+			}
+
+			static constexpr auto unique() noexcept(true) -> bool
+			{
+				for (std::size_t i {0}; i < count; ++i)
+				{
+					for (std::size_t j {i + 1}; j < count; ++j)
+					{
+						if (ids[i] == ids[j])
+						{
+							return false;
+						}
+					}
+				}
+				return true;
+			}
+
+			static constexpr auto search() noexcept(true) -> layout
+			{
+				unsigned bits {0};
+				while ((std::size_t {1} << bits) < count)
+				{
+					++bits;
+				}
+				for (;; ++bits)
+				{
+					for (std::uint64_t seed {0x9E3779B1}; seed < 0x9E3779B1 + 2 * 256; seed += 2)
+					{
+						bool collides {false};
+						for (std::size_t i {0}; i < count && !collides; ++i)
+						{
+							for (std::size_t j {i + 1}; j < count && !collides; ++j)
+							{
+								collides = slot(ids[i], layout {bits, seed}) == slot(ids[j], layout {bits, seed});
+							}
+						}
+						if (!collides)
+						{
+							return layout {bits, seed};
+						}
+					}
+				}
+			}
+
+			static_assert(unique(), "Stable type ids of a variant must be unique!");
+
+			static constexpr layout shape {search()};
+
+			struct entry final
+			{
+				std::uint32_t id;
+				std::size_t   index;
+			};
+
+			static constexpr auto build() noexcept(true) -> std::array<entry, std::size_t {1} << shape.bits>
+			{
+				std::array<entry, std::size_t {1} << shape.bits> r { };
+				for (auto& e : r)
+				{
+					e = entry {0, unmapped};
+				}
+				for (std::size_t i {0}; i < count; ++i)
+				{
+					r[slot(ids[i], shape)] = entry {ids[i], i};
+				}
+				return r;
+			}
+
+			static constexpr std::array<entry, std::size_t {1} << shape.bits> table {build()};
+
+			/* Returns the discriminator of the id or unmapped. */
+			static constexpr auto index(const std::uint64_t id) noexcept(true) -> std::size_t
+			{
+				const auto& e {table[slot(static_cast<std::uint32_t>(id), shape)]};
+				return e.id == id && e.index != unmapped ? e.index : unmapped;
+			}
+		};
+
+		template <typename V>
+		struct variant_codec;
+
+		template <typename Policy, typename... Ts>
+		struct variant_codec<basic_variant<Policy, Ts...>> final
+		{
+			static constexpr bool stable {(has_type_id<Ts>::value && ...)};
+			static_assert(stable || !(has_type_id<Ts>::value || ...), "Either all or none of the alternatives must have a stable type id!");
+
+			static constexpr auto tag(const std::size_t index) noexcept(true) -> std::uint64_t
+			{
+				if constexpr (stable)
+				{
+					return stable_ids<Ts...>::ids[index];
+				}
+				else
+				{
+					return index;
+				}
+			}
+
+			static constexpr auto index(const std::uint64_t tag) noexcept(true) -> std::size_t
+			{
+				if constexpr (stable)
+				{
+					return stable_ids<Ts...>::index(tag);
+				}
+				else
+				{
+					return tag < sizeof...(Ts) ? static_cast<std::size_t>(tag) : unmapped;
+				}
+			}
+		};
+	}
+
+	/*
+	 * Appends the variant to out as its tag, the payload length and the payload, the first two as LEB128.
+	 * The tag is the stdex::type_id of the alternative if the alternatives have ids, else the discriminator.
+	 */
+	template <typename Policy, typename... Ts>
+	inline auto encode(const basic_variant<Policy, Ts...>& variant, std::vector<std::byte>& out) -> void
+	{
+		using mapping = basic_variant<Policy, Ts...>;
+		stdex::detail::dispatch<void, sizeof...(Ts), mapping::detail::dispatch>(variant.index(), [&](auto i) -> void
+		{
+			using type = typename mapping::detail::template alternative<decltype(i)::value>;
+			const auto& value {variant.template get_unchecked<decltype(i)::value>()};
+			const auto  size {value_codec<type>::size(value)};
+			detail::write_varint(out, detail::variant_codec<mapping>::tag(decltype(i)::value));
+			detail::write_varint(out, size);
+			const auto offset {out.size()};
+			out.resize(offset + size);
+			value_codec<type>::write(out.data() + offset, value);
+		});
+	}
+
+	/*
+	 * Decodes one variant written by stdex::encode and advances first past it.
+	 * A tag without alternative is skipped using its length and reported as decode_errc::unknown_id, so decoding can continue with the next one.
+	 */
+	template <typename V>
+	inline auto decode(const std::byte*& first, const std::byte* const last) -> result<V, decode_errc>
+	{
+		std::uint64_t tag {0};
+		std::uint64_t size {0};
+		if (!detail::read_varint(first, last, tag) || !detail::read_varint(first, last, size) || size > static_cast<std::uint64_t>(last - first))
+		{
+			return unexpected {decode_errc::truncated};
+		}
+		const std::byte* const payload {first};
+		first += size;
+		const auto index {detail::variant_codec<V>::index(tag)};
+		if (index == detail::unmapped)
+		{
+			return unexpected {decode_errc::unknown_id};
+		}
+		return stdex::detail::dispatch<result<V, decode_errc>, V::detail::types::size, V::detail::dispatch>(index, [&](auto i) -> result<V, decode_errc>
+		{
+			using type = typename V::detail::template alternative<decltype(i)::value>;
+			auto value {value_codec<type>::read(payload, static_cast<std::size_t>(size))};
+			if (!value)
+			{
+				return unexpected {decode_errc::invalid_payload};
+			}
+			return V {std::in_place_index<decltype(i)::value>, std::move(*value)};
+		});
+	}
+
+	/* Payload encoding of stdex::serialize_batch. */
+	enum class batch_encoding : std::uint8_t
+	{
+		plain,
+		/* Integer alternatives are written as LEB128 zigzag deltas to the previous value of the same alternative. */
+		delta_varint
+	};
+
+	namespace detail
+	{
+		template <typename T, typename = void>
+		struct has_fixed_size final : std::false_type { };
+
+		template <typename T>
+		struct has_fixed_size<T, std::void_t<decltype(value_codec<T>::fixed_size)>> final : std::true_type { };
+
+		template <typename T>
+		inline constexpr bool delta_encodable {std::is_integral_v<T> && !std::is_same_v<T, bool> && has_fixed_size<T>::value};
+
+		constexpr auto zigzag(const std::uint64_t delta) noexcept(true) -> std::uint64_t
+		{
+			return delta << 1 ^ (std::uint64_t {0} - (delta >> 63));
+		}
+
+		constexpr auto unzigzag(const std::uint64_t value) noexcept(true) -> std::uint64_t
+		{
+			return value >> 1 ^ (std::uint64_t {0} - (value & 1));
+		}
+
+		template <typename T>
+		constexpr auto widen_integer(const T value) noexcept(true) -> std::uint64_t
+		{
+			if constexpr (std::is_signed_v<T>)
+			{
+				return static_cast<std::uint64_t>(static_cast<std::int64_t>(value));
+			}
+			else
+			{
+				return static_cast<std::uint64_t>(value);
+			}
+		}
+	}
+
+	/*
+	 * Serializes a range of variants grouped by type: the encoding, the element count and a column of tags,
+	 * followed by one block per alternative in use with the payloads of its elements in order.
+	 * Blocks start with their tag and byte length, so readers skip alternatives they do not know.
+	 * Fixed size payloads are stored back to back, others are prefixed with their length. Tags are those of stdex::encode.
+	 */
+	template <typename Range>
+	inline auto serialize_batch(const Range& variants, const batch_encoding encoding = batch_encoding::plain) -> std::vector<std::byte>
+	{
+		using mapping = std::remove_cv_t<std::remove_reference_t<decltype(*std::begin(variants))>>;
+		constexpr std::size_t n {mapping::detail::types::size};
+
+		std::vector<std::byte>                 tags { };
+		std::array<std::vector<std::byte>, n>  blocks { };
+		std::array<std::uint64_t, n>           previous { };
+		std::array<std::size_t, n>             counts { };
+		std::size_t                            count {0};
+		for (const auto& variant : variants)
+		{
+			stdex::detail::dispatch<void, n, mapping::detail::dispatch>(variant.index(), [&](auto i) -> void
+			{
+				using type = typename mapping::detail::template alternative<decltype(i)::value>;
+				auto&       block {blocks[decltype(i)::value]};
+				const auto& value {variant.template get_unchecked<decltype(i)::value>()};
+				detail::write_varint(tags, detail::variant_codec<mapping>::tag(decltype(i)::value));
+				++counts[decltype(i)::value];
+				if constexpr (detail::delta_encodable<type>)
+				{
+					if (encoding == batch_encoding::delta_varint)
+					{
+						const auto current {detail::widen_integer(value)};
+						detail::write_varint(block, detail::zigzag(current - previous[decltype(i)::value]));
+						previous[decltype(i)::value] = current;
+						return;
+					}
+				}
+				std::size_t size {0};
+				if constexpr (detail::has_fixed_size<type>::value)
+				{
+					size = value_codec<type>::fixed_size;
+				}
+				else
+				{
+					size = value_codec<type>::size(value);
+					detail::write_varint(block, size);
+				}
+				const auto offset {block.size()};
+				block.resize(offset + size);
+				value_codec<type>::write(block.data() + offset, value);
+			});
+			++count;
+		}
+
+		std::vector<std::byte> out {static_cast<std::byte>(encoding)};
+		detail::write_varint(out, count);
+		out.insert(out.end(), tags.begin(), tags.end());
+		detail::write_varint(out, static_cast<std::size_t>(std::count_if(counts.begin(), counts.end(), [](const std::size_t c) { return c != 0; })));
+		for (std::size_t i {0}; i < n; ++i)
+		{
+			if (counts[i] != 0)
+			{
+				detail::write_varint(out, detail::variant_codec<mapping>::tag(i));
+				detail::write_varint(out, blocks[i].size());
+				out.insert(out.end(), blocks[i].begin(), blocks[i].end());
+			}
+		}
+		return out;
+	}
+
+	/*
+	 * Appends the variants serialized by stdex::serialize_batch to the container and advances first past the batch.
+	 * Elements of alternatives unknown to the container's variant are skipped. Returns the number of elements appended,
+	 * on errors the container is left as it was.
+	 */
+	template <typename C>
+	inline auto deserialize_batch(const std::byte*& first, const std::byte* const last, C& container) -> result<std::size_t, decode_errc>
+	{
+		using mapping = typename C::value_type;
+		constexpr std::size_t n {mapping::detail::types::size};
+
+		std::uint64_t count {0};
+		if (first == last)
+		{
+			return unexpected {decode_errc::truncated};
+		}
+		const auto encoding {static_cast<batch_encoding>(*first++)};
+		if (encoding != batch_encoding::plain && encoding != batch_encoding::delta_varint)
+		{
+			return unexpected {decode_errc::invalid_payload};
+		}
+		if (!detail::read_varint(first, last, count))
+		{
+			return unexpected {decode_errc::truncated};
+		}
+
+		/* Skips the tag column to find the blocks. */
+		const std::byte* const tags {first};
+		std::uint64_t          tag {0};
+		for (std::uint64_t i {0}; i < count; ++i)
+		{
+			if (!detail::read_varint(first, last, tag))
+			{
+				return unexpected {decode_errc::truncated};
+			}
+		}
+
+		std::array<const std::byte*, n> cursors { };
+		std::array<const std::byte*, n> ends { };
+		std::uint64_t                   block_count {0};
+		if (!detail::read_varint(first, last, block_count))
+		{
+			return unexpected {decode_errc::truncated};
+		}
+		for (std::uint64_t b {0}; b < block_count; ++b)
+		{
+			std::uint64_t size {0};
+			if (!detail::read_varint(first, last, tag) || !detail::read_varint(first, last, size) || size > static_cast<std::uint64_t>(last - first))
+			{
+				return unexpected {decode_errc::truncated};
+			}
+			const auto index {detail::variant_codec<mapping>::index(tag)};
+			if (index != detail::unmapped)
+			{
+				cursors[index] = first;
+				ends[index] = first + size;
+			}
+			first += size;
+		}
+
+		std::array<std::uint64_t, n> previous { };
+		const std::size_t            initial {container.size()};
+		std::size_t                  appended {0};
+		const std::byte*             column {tags};
+		for (std::uint64_t e {0}; e < count; ++e)
+		{
+			static_cast<void>(detail::read_varint(column, last, tag));
+			const auto index {detail::variant_codec<mapping>::index(tag)};
+			if (index == detail::unmapped)
+			{
+				continue;
+			}
+			const auto status {stdex::detail::dispatch<std::optional<decode_errc>, n, mapping::detail::dispatch>(index, [&](auto i) -> std::optional<decode_errc>
+			{
+				if (cursors[decltype(i)::value] == nullptr)
+				{
+					/* A tag without a payload block. */
+					return decode_errc::truncated;
+				}
+				using type = typename mapping::detail::template alternative<decltype(i)::value>;
+				auto& cursor {cursors[decltype(i)::value]};
+				if constexpr (detail::delta_encodable<type>)
+				{
+					if (encoding == batch_encoding::delta_varint)
+					{
+						std::uint64_t delta {0};
+						if (!detail::read_varint(cursor, ends[decltype(i)::value], delta))
+						{
+							return decode_errc::truncated;
+						}
+						previous[decltype(i)::value] += detail::unzigzag(delta);
+						container.emplace_back(std::in_place_index<decltype(i)::value>, static_cast<type>(previous[decltype(i)::value]));
+						return std::nullopt;
+					}
+				}
+				std::uint64_t size {0};
+				if constexpr (detail::has_fixed_size<type>::value)
+				{
+					size = value_codec<type>::fixed_size;
+				}
+				else
+				{
+					if (!detail::read_varint(cursor, ends[decltype(i)::value], size))
+					{
+						return decode_errc::truncated;
+					}
+				}
+				if (size > static_cast<std::uint64_t>(ends[decltype(i)::value] - cursor))
+				{
+					return decode_errc::truncated;
+				}
+				auto value {value_codec<type>::read(cursor, static_cast<std::size_t>(size))};
+				cursor += size;
+				if (!value)
+				{
+					return decode_errc::invalid_payload;
+				}
+				container.emplace_back(std::in_place_index<decltype(i)::value>, std::move(*value));
+				return std::nullopt;
+			})};
+			if (status)
+			{
+				/* Drops the elements appended so far, so a failed batch leaves the container unchanged. */
+				container.erase(std::next(std::begin(container), static_cast<std::ptrdiff_t>(initial)), std::end(container));
+				return unexpected {*status};
+			}
+			++appended;
+		}
+		return appended;
+	}
+}
+
+#endif
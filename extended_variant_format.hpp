@@ -0,0 +1,216 @@
+/*
+	MIT License
+
+	Copyright 2021 Mario Sieg "pinsrq" <mt3000@gmx.de>
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+ */
+
+/*
+ * stdex::format_to and stdex::format_to_n, allocation free text output of the current alternative through std::to_chars.
+ */
+
+#ifndef EXTENDED_VARIANT_FORMAT_HPP
+#define EXTENDED_VARIANT_FORMAT_HPP
+
+#include "extended_variant.hpp"
+
+#include <charconv>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <string_view>
+
+namespace stdex
+{
+	/*
+	 * Customization point for format_to, specialize it for alternatives which are not
+	 * arithmetic, strings, std::nullptr_t or variants:
+	 * template <typename Out> static auto format(Out out, const T& value) -> Out;
+	 */
+	template <typename T>
+	struct value_formatter;
+
+	namespace detail
+	{
+		/* Two decimal digits for every number below 100. */
+		inline constexpr char digit_pairs[201] {"00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899"};
+
+		template <typename Out>
+		inline auto format_chars(Out out, const char* first, const char* const last) -> Out
+		{
+			while (first != last)
+			{
+				*out++ = *first++;
+			}
+			return out;
+		}
+
+		/* Writes the digits of the integer two at a time from the back of a local buffer. */
+		template <typename Out, typename T>
+		inline auto format_integer(Out out, const T value) -> Out
+		{
+			using unsigned_t = std::make_unsigned_t<T>;
+			char       buffer[std::numeric_limits<unsigned_t>::digits10 + 2];
+			char*      first {std::end(buffer)};
+			unsigned_t rest {static_cast<unsigned_t>(value)};
+			if constexpr (std::is_signed_v<T>)
+			{
+				if (value < 0)
+				{
+					rest = static_cast<unsigned_t>(unsigned_t {0} - rest);
+				}
+			}
+			while (rest >= 100)
+			{
+				const auto pair {static_cast<std::size_t>(rest % 100) * 2};
+				rest /= 100;
+				*--first = digit_pairs[pair + 1];
+				*--first = digit_pairs[pair];
+			}
+			if (rest >= 10)
+			{
+				*--first = digit_pairs[static_cast<std::size_t>(rest) * 2 + 1];
+				*--first = digit_pairs[static_cast<std::size_t>(rest) * 2];
+			}
+			else
+			{
+				*--first = static_cast<char>('0' + rest);
+			}
+			if constexpr (std::is_signed_v<T>)
+			{
+				if (value < 0)
+				{
+					*--first = '-';
+				}
+			}
+			return format_chars(out, first, std::end(buffer));
+		}
+
+		template <typename Out, typename T>
+		inline auto format_value(Out out, const T& value) -> Out
+		{
+			if constexpr (std::is_same_v<T, bool>)
+			{
+				return value ? format_chars(out, "true", "true" + 4) : format_chars(out, "false", "false" + 5);
+			}
+			else if constexpr (std::is_same_v<T, char>)
+			{
+				*out++ = value;
+				return out;
+			}
+			else if constexpr (std::is_integral_v<T>)
+			{
+				return format_integer(out, value);
+			}
+			else if constexpr (std::is_floating_point_v<T>)
+			{
+				/* std::to_chars without a precision writes the shortest representation which round trips. */
+				char       buffer[64];
+				const auto r {std::to_chars(std::begin(buffer), std::end(buffer), value)};
+				return format_chars(out, std::begin(buffer), r.ptr);
+			}
+			else if constexpr (std::is_same_v<T, std::nullptr_t>)
+			{
+				return format_chars(out, "null", "null" + 4);
+			}
+			else if constexpr (std::is_convertible_v<const T&, std::string_view>)
+			{
+				const std::string_view s {value};
+				return format_chars(out, s.data(), s.data() + s.size());
+			}
+			else if constexpr (is_variant<T>::value)
+			{
+				return value.visit([&](const auto& alternative) -> Out
+				{
+					return format_value(out, alternative);
+				});
+			}
+			else
+			{
+				return value_formatter<T>::format(out, value);
+			}
+		}
+	}
+
+	/*
+	 * Writes the current alternative of the variant as text to the output iterator and returns the iterator past the end.
+	 * Integers are written with a table of digit pairs and floating point numbers in their shortest round trip form,
+	 * so writing into a caller provided buffer never allocates.
+	 */
+	template <typename Out, typename Policy, typename... Ts>
+	inline auto format_to(Out out, const basic_variant<Policy, Ts...>& variant) -> Out
+	{
+		return detail::format_value(out, variant);
+	}
+
+	/* Result of stdex::format_to_n: the iterator past the last character written and the length of the whole text. */
+	template <typename Out>
+	struct format_to_n_result final
+	{
+		Out         out;
+		std::size_t size;
+	};
+
+	namespace detail
+	{
+		/* Output iterator writing at most limit characters to out and counting all of them. */
+		template <typename Out>
+		struct truncating_output final
+		{
+			Out         out;
+			std::size_t limit;
+			std::size_t size;
+
+			inline auto operator *() noexcept(true) -> truncating_output&
+			{
+				return *this;
+			}
+
+			inline auto operator ++() noexcept(true) -> truncating_output&
+			{
+				return *this;
+			}
+
+			inline auto operator ++(int) noexcept(true) -> truncating_output&
+			{
+				return *this;
+			}
+
+			inline auto operator =(const char c) -> truncating_output&
+			{
+				if (this->size++ < this->limit)
+				{
+					*this->out++ = c;
+				}
+				return *this;
+			}
+		};
+	}
+
+	/* Like stdex::format_to, but writes at most n characters, for fixed size buffers. */
+	template <typename Out, typename Policy, typename... Ts>
+	inline auto format_to_n(Out out, const std::size_t n, const basic_variant<Policy, Ts...>& variant) -> format_to_n_result<Out>
+	{
+		const auto r {detail::format_value(detail::truncating_output<Out> {out, n, 0}, variant)};
+		return format_to_n_result<Out> {r.out, r.size};
+	}
+}
+
+#endif
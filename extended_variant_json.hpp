@@ -0,0 +1,515 @@
+/*
+	MIT License
+
+	Copyright 2021 Mario Sieg "pinsrq" <mt3000@gmx.de>
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+ */
+
+/*
+ * stdex::parse_json and stdex::parse_json_lines, an in-situ SAX-style JSON parser which hands variants to a handler.
+ */
+
+#ifndef EXTENDED_VARIANT_JSON_HPP
+#define EXTENDED_VARIANT_JSON_HPP
+
+#include "extended_variant.hpp"
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace stdex
+{
+	/* Reasons for parse_json and parse_json_lines to stop. */
+	enum class json_errc : std::uint8_t
+	{
+		unexpected_end,
+		unexpected_character,
+		invalid_literal,
+		invalid_number,
+		invalid_string,
+		nesting_too_deep,
+		trailing_characters
+	};
+
+	/* The reason and the byte offset into the input where parsing stopped. */
+	struct json_error final
+	{
+		json_errc   code;
+		std::size_t offset;
+	};
+
+	/* Maximum nesting of arrays and objects accepted by the JSON parser. */
+	inline constexpr std::size_t json_max_depth {512};
+
+	namespace detail
+	{
+		/*
+		 * Recursive descent JSON parser reporting SAX events to a handler.
+		 * Values are constructed directly as the variant V, strings are decoded in place and handed out as views into the input.
+		 */
+		template <typename V, typename H>
+		class json_parser final
+		{
+			static_assert(V::detail::types::template contains<std::nullptr_t>, "Variant must hold std::nullptr_t to represent null!");
+			static_assert(V::detail::types::template contains<bool>, "Variant must hold bool to represent true and false!");
+			static_assert(V::detail::types::template contains<double>, "Variant must hold double to represent numbers!");
+			static_assert(V::detail::types::template contains<std::string_view>, "Variant must hold std::string_view to represent strings!");
+
+		private:
+			char* const origin_;
+			char*       cursor_;
+			char* const end_;
+			H&          handler_;
+			json_error  error_ { };
+
+		public:
+			json_parser(char* const origin, char* const first, char* const last, H& handler) noexcept(true) : origin_ {origin}, cursor_ {first}, end_ {last}, handler_ {handler} { }
+
+			/* Parses a single value which may only be surrounded by whitespace. */
+			auto document() -> bool
+			{
+				if (!this->value(0))
+				{
+					return false;
+				}
+				this->skip_whitespace();
+				return this->cursor_ == this->end_ || this->fail(json_errc::trailing_characters);
+			}
+
+			[[nodiscard]]
+			auto error() const noexcept(true) -> json_error
+			{
+				return this->error_;
+			}
+
+		private:
+			auto fail(const json_errc code) noexcept(true) -> bool
+			{
+				this->error_ = json_error {code, static_cast<std::size_t>(this->cursor_ - this->origin_)};
+				return false;
+			}
+
+			template <typename T>
+			inline auto emit(const T value) -> void
+			{
+				this->handler_.value(V {std::in_place_index<static_cast<std::size_t>(V::template index_of<T>())>, value});
+			}
+
+			inline auto skip_whitespace() noexcept(true) -> void
+			{
+				while (this->cursor_ != this->end_ && (*this->cursor_ == ' ' || *this->cursor_ == '\n' || *this->cursor_ == '\r' || *this->cursor_ == '\t'))
+				{
+					++this->cursor_;
+				}
+			}
+
+			inline auto accept(const char c) noexcept(true) -> bool
+			{
+				const bool match {this->cursor_ != this->end_ && *this->cursor_ == c};
+				this->cursor_ += match;
+				return match;
+			}
+
+			inline auto digits() noexcept(true) -> std::size_t
+			{
+				char* const first {this->cursor_};
+				while (this->cursor_ != this->end_ && static_cast<unsigned char>(*this->cursor_ - '0') < 10)
+				{
+					++this->cursor_;
+				}
+				return static_cast<std::size_t>(this->cursor_ - first);
+			}
+
+			/* Skips whitespace and consumes the separator or the closing bracket, more tells which one. */
+			auto next(const char close, bool& more) -> bool
+			{
+				this->skip_whitespace();
+				if (this->cursor_ == this->end_)
+				{
+					return this->fail(json_errc::unexpected_end);
+				}
+				more = *this->cursor_ == ',';
+				if (!more && *this->cursor_ != close)
+				{
+					return this->fail(json_errc::unexpected_character);
+				}
+				++this->cursor_;
+				return true;
+			}
+
+			auto value(const std::size_t depth) -> bool
+			{
+				this->skip_whitespace();
+				if (this->cursor_ == this->end_)
+				{
+					return this->fail(json_errc::unexpected_end);
+				}
+				switch (*this->cursor_)
+				{
+					case '{':
+						return this->object(depth);
+					case '[':
+						return this->array(depth);
+					case '"':
+					{
+						std::string_view s { };
+						if (!this->string(s))
+						{
+							return false;
+						}
+						this->emit<std::string_view>(s);
+						return true;
+					}
+					case 't':
+						return this->literal("true", true);
+					case 'f':
+						return this->literal("false", false);
+					case 'n':
+						return this->literal("null", nullptr);
+					default:
+						return this->number();
+				}
+			}
+
+			auto object(const std::size_t depth) -> bool
+			{
+				if (depth == json_max_depth)
+				{
+					return this->fail(json_errc::nesting_too_deep);
+				}
+				++this->cursor_;
+				this->handler_.begin_object();
+				this->skip_whitespace();
+				bool more {!this->accept('}')};
+				while (more)
+				{
+					std::string_view key { };
+					this->skip_whitespace();
+					if (this->cursor_ == this->end_)
+					{
+						return this->fail(json_errc::unexpected_end);
+					}
+					if (*this->cursor_ != '"')
+					{
+						return this->fail(json_errc::unexpected_character);
+					}
+					if (!this->string(key))
+					{
+						return false;
+					}
+					this->handler_.key(key);
+					this->skip_whitespace();
+					if (!this->accept(':'))
+					{
+						return this->fail(this->cursor_ == this->end_ ? json_errc::unexpected_end : json_errc::unexpected_character);
+					}
+					if (!this->value(depth + 1) || !this->next('}', more))
+					{
+						return false;
+					}
+				}
+				this->handler_.end_object();
+				return true;
+			}
+
+			auto array(const std::size_t depth) -> bool
+			{
+				if (depth == json_max_depth)
+				{
+					return this->fail(json_errc::nesting_too_deep);
+				}
+				++this->cursor_;
+				this->handler_.begin_array();
+				this->skip_whitespace();
+				bool more {!this->accept(']')};
+				while (more)
+				{
+					if (!this->value(depth + 1) || !this->next(']', more))
+					{
+						return false;
+					}
+				}
+				this->handler_.end_array();
+				return true;
+			}
+
+			template <typename T>
+			auto literal(const std::string_view word, const T value) -> bool
+			{
+				if (static_cast<std::size_t>(this->end_ - this->cursor_) < word.size() || std::string_view {this->cursor_, word.size()} != word)
+				{
+					return this->fail(json_errc::invalid_literal);
+				}
+				this->cursor_ += word.size();
+				this->emit<T>(value);
+				return true;
+			}
+
+			auto number() -> bool
+			{
+				char* const first {this->cursor_};
+				bool        integral {true};
+				const bool  negative {this->accept('-')};
+				const auto  whole {this->digits()};
+				if (whole == 0 && !negative)
+				{
+					return this->fail(json_errc::unexpected_character);
+				}
+				if (whole == 0 || (whole > 1 && first[negative] == '0'))
+				{
+					this->cursor_ = first;
+					return this->fail(json_errc::invalid_number);
+				}
+				if (this->accept('.'))
+				{
+					integral = false;
+					if (this->digits() == 0)
+					{
+						this->cursor_ = first;
+						return this->fail(json_errc::invalid_number);
+					}
+				}
+				if (this->accept('e') || this->accept('E'))
+				{
+					integral = false;
+					if (!this->accept('+'))
+					{
+						this->accept('-');
+					}
+					if (this->digits() == 0)
+					{
+						this->cursor_ = first;
+						return this->fail(json_errc::invalid_number);
+					}
+				}
+				if constexpr (V::detail::types::template contains<std::int64_t>)
+				{
+					/* Integers beyond the range of std::int64_t fall back to double. */
+					std::int64_t value {0};
+					if (integral && std::from_chars(first, this->cursor_, value).ec == std::errc { })
+					{
+						this->emit<std::int64_t>(value);
+						return true;
+					}
+				}
+				double value {0.0};
+				if (std::from_chars(first, this->cursor_, value).ec != std::errc { })
+				{
+					this->cursor_ = first;
+					return this->fail(json_errc::invalid_number);
+				}
+				this->emit<double>(value);
+				return true;
+			}
+
+			auto hex4(std::uint32_t& code) noexcept(true) -> bool
+			{
+				if (this->end_ - this->cursor_ < 4)
+				{
+					return this->fail(json_errc::unexpected_end);
+				}
+				for (std::size_t i {0}; i < 4; ++i, ++this->cursor_)
+				{
+					const auto digit {static_cast<std::uint32_t>(static_cast<unsigned char>(*this->cursor_) - '0')};
+					const auto letter {static_cast<std::uint32_t>(static_cast<unsigned char>(*this->cursor_ | 0x20) - 'a')};
+					if (digit < 10)
+					{
+						code = code << 4 | digit;
+					}
+					else if (letter < 6)
+					{
+						code = code << 4 | (letter + 10);
+					}
+					else
+					{
+						return this->fail(json_errc::invalid_string);
+					}
+				}
+				return true;
+			}
+
+			/* Writes the code point as UTF-8. An escape is at least as long as its encoding, so this never overtakes the cursor. */
+			static auto encode_utf8(char* out, const std::uint32_t code) noexcept(true) -> char*
+			{
+				if (code < 0x80)
+				{
+					*out++ = static_cast<char>(code);
+				}
+				else if (code < 0x800)
+				{
+					*out++ = static_cast<char>(0xC0 | code >> 6);
+					*out++ = static_cast<char>(0x80 | (code & 0x3F));
+				}
+				else if (code < 0x10000)
+				{
+					*out++ = static_cast<char>(0xE0 | code >> 12);
+					*out++ = static_cast<char>(0x80 | (code >> 6 & 0x3F));
+					*out++ = static_cast<char>(0x80 | (code & 0x3F));
+				}
+				else
+				{
+					*out++ = static_cast<char>(0xF0 | code >> 18);
+					*out++ = static_cast<char>(0x80 | (code >> 12 & 0x3F));
+					*out++ = static_cast<char>(0x80 | (code >> 6 & 0x3F));
+					*out++ = static_cast<char>(0x80 | (code & 0x3F));
+				}
+				return out;
+			}
+
+			/* Parses a string, decoding escapes in place. Strings without escapes are never written to. */
+			auto string(std::string_view& out) -> bool
+			{
+				char* const first {++this->cursor_};
+				while (this->cursor_ != this->end_ && *this->cursor_ != '"' && *this->cursor_ != '\\' && static_cast<unsigned char>(*this->cursor_) >= 0x20)
+				{
+					++this->cursor_;
+				}
+				char* write {this->cursor_};
+				while (this->cursor_ != this->end_)
+				{
+					const char c {*this->cursor_};
+					if (c == '"')
+					{
+						out = std::string_view {first, static_cast<std::size_t>(write - first)};
+						++this->cursor_;
+						return true;
+					}
+					if (static_cast<unsigned char>(c) < 0x20)
+					{
+						return this->fail(json_errc::invalid_string);
+					}
+					if (c != '\\')
+					{
+						*write++ = c;
+						++this->cursor_;
+						continue;
+					}
+					if (++this->cursor_ == this->end_)
+					{
+						break;
+					}
+					switch (*this->cursor_++)
+					{
+						case '"':  *write++ = '"';  break;
+						case '\\': *write++ = '\\'; break;
+						case '/':  *write++ = '/';  break;
+						case 'b':  *write++ = '\b'; break;
+						case 'f':  *write++ = '\f'; break;
+						case 'n':  *write++ = '\n'; break;
+						case 'r':  *write++ = '\r'; break;
+						case 't':  *write++ = '\t'; break;
+						case 'u':
+						{
+							std::uint32_t code {0};
+							if (!this->hex4(code))
+							{
+								return false;
+							}
+							if (code >= 0xD800 && code < 0xDC00)
+							{
+								std::uint32_t low {0};
+								if (!this->accept('\\') || !this->accept('u'))
+								{
+									return this->fail(json_errc::invalid_string);
+								}
+								if (!this->hex4(low))
+								{
+									return false;
+								}
+								if (low < 0xDC00 || low >= 0xE000)
+								{
+									return this->fail(json_errc::invalid_string);
+								}
+								code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+							}
+							else if (code >= 0xDC00 && code < 0xE000)
+							{
+								return this->fail(json_errc::invalid_string);
+							}
+							write = encode_utf8(write, code);
+							break;
+						}
+						default:
+							--this->cursor_;
+							return this->fail(json_errc::invalid_string);
+					}
+				}
+				return this->fail(json_errc::unexpected_end);
+			}
+		};
+	}
+
+	/*
+	 * Parses a JSON document without building a DOM, reporting SAX events to the handler:
+	 * handler.value(V&&) for scalars, handler.key(std::string_view) for object keys
+	 * and handler.begin_object(), end_object(), begin_array(), end_array() for the structure.
+	 * V must hold std::nullptr_t, bool, double and std::string_view; integers are reported as std::int64_t if V holds it, else as double.
+	 * Escaped strings are decoded in place, so the buffer is modified and string views stay valid as long as the buffer does.
+	 * Returns the number of bytes parsed or the error.
+	 */
+	template <typename V, typename H>
+	inline auto parse_json(char* const data, const std::size_t size, H& handler) -> result<std::size_t, json_error>
+	{
+		detail::json_parser<V, H> parser {data, data, data + size, handler};
+		if (!parser.document())
+		{
+			return unexpected {parser.error()};
+		}
+		return size;
+	}
+
+	/*
+	 * Parses JSON lines, one document per line, like parse_json. Blank lines are skipped.
+	 * Calls handler.end_document() after every document and returns the number of documents or the first error.
+	 */
+	template <typename V, typename H>
+	inline auto parse_json_lines(char* const data, const std::size_t size, H& handler) -> result<std::size_t, json_error>
+	{
+		char* const end {data + size};
+		std::size_t count {0};
+		for (char* line {data}; line != end;)
+		{
+			auto* const newline {static_cast<char*>(std::memchr(line, '\n', static_cast<std::size_t>(end - line)))};
+			char* const last {newline ? newline : end};
+			char*       first {line};
+			while (first != last && (*first == ' ' || *first == '\r' || *first == '\t'))
+			{
+				++first;
+			}
+			if (first != last)
+			{
+				detail::json_parser<V, H> parser {data, first, last, handler};
+				if (!parser.document())
+				{
+					return unexpected {parser.error()};
+				}
+				handler.end_document();
+				++count;
+			}
+			line = newline ? newline + 1 : end;
+		}
+		return count;
+	}
+}
+
+#endif
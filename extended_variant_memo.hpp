@@ -0,0 +1,251 @@
+/*
+	MIT License
+
+	Copyright 2021 Mario Sieg "pinsrq" <mt3000@gmx.de>
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+ */
+
+/*
+ * stdex::variant_memo, a sharded concurrent cache keyed by variants, built on std::mutex and std::unordered_map.
+ */
+
+#ifndef EXTENDED_VARIANT_MEMO_HPP
+#define EXTENDED_VARIANT_MEMO_HPP
+
+#include "extended_variant.hpp"
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+namespace stdex
+{
+	/*
+	 * Concurrent memoization cache mapping variant keys to values of R.
+	 * Every alternative owns its own shards, so lookups of different alternatives never contend.
+	 * Keys are hashed by their alternative only and each shard evicts with the CLOCK algorithm once full.
+	 */
+	template <typename V, typename R>
+	class variant_memo;
+
+	template <typename Policy, typename... Ts, typename R>
+	class variant_memo<basic_variant<Policy, Ts...>, R> final
+	{
+	public:
+		using key_type    = basic_variant<Policy, Ts...>;
+		using mapped_type = R;
+
+	private:
+		struct hasher final
+		{
+			inline auto operator ()(const key_type& key) const -> std::size_t
+			{
+				return stdex::detail::hash_alternative(key);
+			}
+		};
+
+		struct entry final
+		{
+			R    value;
+			bool referenced;
+		};
+
+		using map = std::unordered_map<key_type, entry, hasher>;
+
+		/* Aligned to a cache line, so neighbouring shards do not share their mutex line. */
+		struct alignas(64) shard final
+		{
+			std::mutex                               mutex { };
+			map                                      entries { };
+			std::vector<typename map::value_type*>   clock { };
+			std::size_t                              hand {0};
+			std::size_t                              hits {0};
+			std::size_t                              misses {0};
+		};
+
+		std::size_t              capacity_;
+		std::size_t              shards_;
+		std::unique_ptr<shard[]> table_;
+
+		/* The alternative selects the shard group, the hash the shard inside it. */
+		inline auto shard_of(const key_type& key) const -> shard&
+		{
+			const auto h {stdex::detail::mix_hash(stdex::detail::hash_alternative(key))};
+			return this->table_[key.index() * this->shards_ + h % this->shards_];
+		}
+
+		/* Inserts the entry, evicting the first entry not referenced since the hand last passed it. */
+		static auto insert(shard& s, const std::size_t capacity, const key_type& key, const R& value) -> void
+		{
+			if (s.entries.find(key) != s.entries.end())
+			{
+				return;
+			}
+			if (s.clock.size() < capacity)
+			{
+				s.clock.push_back(&*s.entries.emplace(key, entry {value, false}).first);
+				return;
+			}
+			for (;; s.hand = (s.hand + 1) % capacity)
+			{
+				auto* const victim {s.clock[s.hand]};
+				if (victim->second.referenced)
+				{
+					victim->second.referenced = false;
+					continue;
+				}
+				s.entries.erase(victim->first);
+				s.clock[s.hand] = &*s.entries.emplace(key, entry {value, false}).first;
+				s.hand = (s.hand + 1) % capacity;
+				return;
+			}
+		}
+
+	public:
+		/*
+		 * Creates a cache holding up to capacity entries per alternative, spread over the given number of shards.
+		 * Zero shards are raised to one, and every shard holds at least one entry.
+		 */
+		explicit variant_memo(const std::size_t capacity, const std::size_t shards = 4)
+			: capacity_ {std::max<std::size_t>((capacity + std::max<std::size_t>(shards, 1) - 1) / std::max<std::size_t>(shards, 1), 1)},
+			shards_ {std::max<std::size_t>(shards, 1)}, table_ {std::make_unique<shard[]>(sizeof...(Ts) * this->shards_)}
+		{
+			for (std::size_t i {0}; i < sizeof...(Ts) * this->shards_; ++i)
+			{
+				this->table_[i].clock.reserve(this->capacity_);
+			}
+		}
+
+		variant_memo(const variant_memo&) = delete;
+		variant_memo(variant_memo&&) = delete;
+		auto operator =(const variant_memo&) -> variant_memo& = delete;
+		auto operator =(variant_memo&&) -> variant_memo& = delete;
+		~variant_memo() = default;
+
+		/* Returns the cached value of the key, or std::nullopt. */
+		[[nodiscard]]
+		auto find(const key_type& key) -> std::optional<R>
+		{
+			auto&                   s {this->shard_of(key)};
+			const std::scoped_lock lock {s.mutex};
+			const auto              i {s.entries.find(key)};
+			if (i == s.entries.end())
+			{
+				++s.misses;
+				return std::nullopt;
+			}
+			++s.hits;
+			i->second.referenced = true;
+			return i->second.value;
+		}
+
+		/*
+		 * Returns the cached value of the key, else invokes compute with the key and caches the result.
+		 * compute runs without holding the shard lock, so concurrent misses of one key may compute it more than once.
+		 */
+		template <typename F>
+		[[nodiscard]]
+		auto get_or_compute(const key_type& key, F&& compute) -> R
+		{
+			if (auto cached {this->find(key)})
+			{
+				return std::move(*cached);
+			}
+			R value {std::invoke(std::forward<F>(compute), key)};
+			auto&                  s {this->shard_of(key)};
+			const std::scoped_lock lock {s.mutex};
+			insert(s, this->capacity_, key, value);
+			return value;
+		}
+
+		/* Inserts or replaces the cached value of the key. */
+		auto store(const key_type& key, R value) -> void
+		{
+			auto&                  s {this->shard_of(key)};
+			const std::scoped_lock lock {s.mutex};
+			if (const auto i {s.entries.find(key)}; i != s.entries.end())
+			{
+				i->second.value = std::move(value);
+				return;
+			}
+			insert(s, this->capacity_, key, value);
+		}
+
+		/* Removes all entries and resets the statistics. */
+		auto clear() -> void
+		{
+			for (std::size_t i {0}; i < sizeof...(Ts) * this->shards_; ++i)
+			{
+				auto&                  s {this->table_[i]};
+				const std::scoped_lock lock {s.mutex};
+				s.clock.clear();
+				s.entries.clear();
+				s.hand = s.hits = s.misses = 0;
+			}
+		}
+
+		/* Number of cached entries. */
+		[[nodiscard]]
+		auto size() const -> std::size_t
+		{
+			return this->accumulate(&shard::entries);
+		}
+
+		/* Number of lookups which found a cached value. */
+		[[nodiscard]]
+		auto hits() const -> std::size_t
+		{
+			return this->accumulate(&shard::hits);
+		}
+
+		/* Number of lookups which did not find a cached value. */
+		[[nodiscard]]
+		auto misses() const -> std::size_t
+		{
+			return this->accumulate(&shard::misses);
+		}
+
+	private:
+		template <typename M>
+		auto accumulate(M shard::* const member) const -> std::size_t
+		{
+			std::size_t r {0};
+			for (std::size_t i {0}; i < sizeof...(Ts) * this->shards_; ++i)
+			{
+				auto&                  s {this->table_[i]};
+				const std::scoped_lock lock {s.mutex};
+				if constexpr (std::is_same_v<M, map>)
+				{
+					r += (s.*member).size();
+				}
+				else
+				{
+					r += s.*member;
+				}
+			}
+			return r;
+		}
+	};
+}
+
+#endif
@@ -0,0 +1,98 @@
+/*
+	MIT License
+
+	Copyright 2021 Mario Sieg "pinsrq" <mt3000@gmx.de>
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+ */
+
+/*
+ * stdex::fold_by_type_parallel, which spreads stdex::fold_by_type over std::thread workers.
+ */
+
+#ifndef EXTENDED_VARIANT_PARALLEL_HPP
+#define EXTENDED_VARIANT_PARALLEL_HPP
+
+#include "extended_variant.hpp"
+
+#include <cstddef>
+#include <iterator>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+namespace stdex
+{
+	namespace detail
+	{
+		/* Merges every accumulator of source into target. */
+		template <typename Accs, typename M, std::size_t... Is>
+		inline auto merge_accumulators(Accs& target, Accs&& source, M& merge, std::index_sequence<Is...>) -> void
+		{
+			((std::get<Is>(target) = std::invoke(merge, std::move(std::get<Is>(target)), std::move(std::get<Is>(source)))), ...);
+		}
+
+		/* Inputs shorter than this per thread are not worth spawning a thread for. */
+		inline constexpr std::size_t parallel_fold_grain {16384};
+	}
+
+	/*
+	 * Parallel stdex::fold_by_type over a random access range.
+	 * Every thread folds a chunk into its own copy of init, the partial results are combined as acc = merge(std::move(acc), std::move(partial)).
+	 * init must therefore be the identity of merge, and reducers are invoked concurrently.
+	 */
+	template <typename Range, typename... Accs, typename M, typename... Fs>
+	[[nodiscard]]
+	inline auto fold_by_type_parallel(Range&& range, const std::tuple<Accs...>& init, M&& merge, Fs&&...reducers) -> std::tuple<Accs...>
+	{
+		const auto first {std::begin(range)};
+		const auto last {std::end(range)};
+		static_assert(std::is_base_of_v<std::random_access_iterator_tag, typename std::iterator_traits<std::remove_const_t<decltype(first)>>::iterator_category>, "Parallel folding requires a random access range!");
+		const auto  size {static_cast<std::size_t>(last - first)};
+		std::size_t workers {std::min<std::size_t>(std::max(std::thread::hardware_concurrency(), 1U), size / stdex::detail::parallel_fold_grain)};
+		workers = std::max<std::size_t>(workers, 1);
+
+		std::vector<std::tuple<Accs...>> partials (workers, init);
+		std::vector<std::thread>         threads { };
+		threads.reserve(workers - 1);
+		const auto chunk = [&](const std::size_t w)
+		{
+			return first + static_cast<std::ptrdiff_t>(size * w / workers);
+		};
+		for (std::size_t w {1}; w < workers; ++w)
+		{
+			threads.emplace_back([&, w]
+			{
+				stdex::detail::fold_runs(chunk(w), chunk(w + 1), partials[w], reducers...);
+			});
+		}
+		stdex::detail::fold_runs(chunk(0), chunk(1), partials[0], reducers...);
+		for (auto& thread : threads)
+		{
+			thread.join();
+		}
+		for (std::size_t w {1}; w < workers; ++w)
+		{
+			stdex::detail::merge_accumulators(partials[0], std::move(partials[w]), merge, std::index_sequence_for<Accs...> { });
+		}
+		return std::move(partials[0]);
+	}
+}
+
+#endif
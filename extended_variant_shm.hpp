@@ -0,0 +1,415 @@
+/*
+	MIT License
+
+	Copyright 2021 Mario Sieg "pinsrq" <mt3000@gmx.de>
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+ */
+
+/*
+ * stdex::shm_variant_ring, passing variants between processes through shared memory.
+ * Linux only (memfd and futex), kept out of extended_variant.hpp so the core header does not pull in the POSIX headers.
+ */
+
+#ifndef EXTENDED_VARIANT_SHM_HPP
+#define EXTENDED_VARIANT_SHM_HPP
+
+#include "extended_variant.hpp"
+
+#include <cerrno>
+#include <climits>
+#include <system_error>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace stdex
+{
+	namespace detail
+	{
+		/* Blocks while the word equals expected. The futex is not private, so it works across processes mapping the same memory. */
+		inline auto futex_wait(std::atomic<std::uint32_t>& word, const std::uint32_t expected) noexcept(true) -> void
+		{
+			::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAIT, expected, nullptr, nullptr, 0);
+		}
+
+		inline auto futex_wake(std::atomic<std::uint32_t>& word) noexcept(true) -> void
+		{
+			::syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&word), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+		}
+
+		inline auto last_error() noexcept(true) -> std::error_code
+		{
+			return std::error_code {errno, std::system_category()};
+		}
+	}
+
+	/*
+	 * Single producer, single consumer ring of stdex::variant<Ts...> in shared memory, for exchanging variants between processes.
+	 * The segment is a named POSIX shared memory object or an anonymous memfd, whose descriptor is passed on to the other process.
+	 * Alternatives must be trivially copyable, as they are copied bytewise into the segment.
+	 * Waiting sides sleep on a process shared futex, which is only woken when a waiter announced itself.
+	 */
+	template <typename... Ts>
+	class shm_variant_ring final
+	{
+		static_assert(std::conjunction_v<std::is_trivially_copyable<Ts>...>, "Shared memory rings require trivially copyable alternatives!");
+		static_assert(std::atomic<std::uint32_t>::is_always_lock_free && sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t), "Futex words must be plain lock free 32 bit integers!");
+
+	public:
+		using value_type = variant<Ts...>;
+
+	private:
+		/* An alternative as discriminator and bytes. */
+		struct slot final
+		{
+			std::uint32_t index;
+			alignas(Ts...) unsigned char bytes[value_type::detail::max_size];
+		};
+
+		/* Identifies the layout, so rings of different alternatives or builds do not attach to each other. */
+		static constexpr auto layout() noexcept(true) -> std::uint64_t
+		{
+			std::uint64_t r {0x7374646578726E67 ^ sizeof(slot)};
+			((r = (r ^ (sizeof(Ts) << 16 | alignof(Ts))) * 0x100000001B3), ...);
+			return r;
+		}
+
+		static constexpr std::uint64_t fingerprint {layout()};
+
+		struct header final
+		{
+			std::uint64_t fingerprint;
+			std::uint32_t capacity;
+
+			/* Written by the producer. */
+			alignas(64) std::atomic<std::uint32_t> head;
+			std::atomic<std::uint32_t> reader_waiting;
+
+			/* Written by the consumer. */
+			alignas(64) std::atomic<std::uint32_t> tail;
+			std::atomic<std::uint32_t> writer_waiting;
+		};
+
+		header*       header_ {nullptr};
+		slot*         slots_ {nullptr};
+		std::size_t   mapped_ {0};
+		std::uint32_t capacity_ {0}; /* Copied out of the header, which the other process can overwrite. */
+		std::size_t   dropped_ {0};
+		int           fd_ {-1};
+
+		static constexpr auto bytes(const std::uint32_t capacity) noexcept(true) -> std::size_t
+		{
+			return (sizeof(header) + alignof(slot) - 1) / alignof(slot) * alignof(slot) + sizeof(slot) * capacity;
+		}
+
+		shm_variant_ring(const int fd, void* const mapping, const std::size_t mapped, const std::uint32_t capacity) noexcept(true)
+			: header_ {static_cast<header*>(mapping)}, slots_ {reinterpret_cast<slot*>(static_cast<unsigned char*>(mapping) + bytes(0))}, mapped_ {mapped}, capacity_ {capacity}, fd_ {fd} { }
+
+		/* Sizes and initializes a fresh segment, the descriptor is closed on failure. */
+		static auto initialize(const int fd, const std::uint32_t requested) -> result<shm_variant_ring, std::error_code>
+		{
+			std::uint32_t capacity {1};
+			while (capacity < requested && capacity < (std::uint32_t {1} << 31))
+			{
+				capacity <<= 1;
+			}
+			const auto size {bytes(capacity)};
+			void*      mapping {MAP_FAILED};
+			if (::ftruncate(fd, static_cast<off_t>(size)) != 0 || (mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+			{
+				const auto error {detail::last_error()};
+				::close(fd);
+				return unexpected {error};
+			}
+			auto* const h {::new (mapping) header { }};
+			h->capacity = capacity;
+			h->fingerprint = fingerprint;
+			return shm_variant_ring {fd, mapping, size, capacity};
+		}
+
+		/* Maps an initialized segment, the descriptor is closed on failure. */
+		static auto map(const int fd) -> result<shm_variant_ring, std::error_code>
+		{
+			struct stat info { };
+			void*       mapping {MAP_FAILED};
+			if (::fstat(fd, &info) != 0 || (mapping = ::mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) == MAP_FAILED)
+			{
+				const auto error {detail::last_error()};
+				::close(fd);
+				return unexpected {error};
+			}
+			const auto* const   h {static_cast<const header*>(mapping)};
+			const std::uint32_t capacity {static_cast<std::size_t>(info.st_size) < sizeof(header) ? 0 : h->capacity};
+			if (capacity == 0 || (capacity & (capacity - 1)) != 0 || h->fingerprint != fingerprint || bytes(capacity) != static_cast<std::size_t>(info.st_size))
+			{
+				::munmap(mapping, static_cast<std::size_t>(info.st_size));
+				::close(fd);
+				return unexpected {std::make_error_code(std::errc::invalid_argument)};
+			}
+			return shm_variant_ring {fd, mapping, static_cast<std::size_t>(info.st_size), capacity};
+		}
+
+		inline auto write(slot& s, const value_type& value) noexcept(true) -> void
+		{
+			s.index = static_cast<std::uint32_t>(value.index());
+			stdex::detail::dispatch<void, sizeof...(Ts), value_type::detail::dispatch>(value.index(), [&](auto i) -> void
+			{
+				std::memcpy(s.bytes, &value.template get_unchecked<decltype(i)::value>(), sizeof(typename value_type::detail::template alternative<decltype(i)::value>));
+			});
+		}
+
+		/* Whether assigning a variant through Out can not throw. */
+		template <typename Out>
+		static constexpr bool nothrow_output {noexcept(*std::declval<Out&>()++ = std::declval<value_type>())};
+
+		/* Writes the variant of the slot to out, returns false if the discriminator the other process wrote is out of range. */
+		template <typename Out>
+		static inline auto read(const slot& s, Out& out) noexcept(nothrow_output<Out>) -> bool
+		{
+			const std::uint32_t index {s.index};
+			if (index >= sizeof...(Ts))
+			{
+				return false;
+			}
+			stdex::detail::dispatch<void, sizeof...(Ts), value_type::detail::dispatch>(index, [&](auto i) -> void
+			{
+				using type = typename value_type::detail::template alternative<decltype(i)::value>;
+				*out++ = value_type {std::in_place_index<decltype(i)::value>, stdex::detail::load_as<type>(s.bytes)};
+			});
+			return true;
+		}
+
+		/* Sleeps on word until it differs from seen, announcing the waiter in flag first. */
+		static inline auto wait(std::atomic<std::uint32_t>& word, std::atomic<std::uint32_t>& flag, const std::uint32_t seen) noexcept(true) -> void
+		{
+			flag.store(1, std::memory_order_seq_cst);
+			if (word.load(std::memory_order_seq_cst) == seen)
+			{
+				detail::futex_wait(word, seen);
+			}
+			flag.store(0, std::memory_order_relaxed);
+		}
+
+		static inline auto notify(std::atomic<std::uint32_t>& word, std::atomic<std::uint32_t>& flag) noexcept(true) -> void
+		{
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (flag.load(std::memory_order_relaxed) != 0)
+			{
+				detail::futex_wake(word);
+			}
+		}
+
+	public:
+		/* Creates the named shared memory object, which must not exist yet, with room for at least capacity variants. */
+		static auto create(const char* const name, const std::uint32_t capacity) -> result<shm_variant_ring, std::error_code>
+		{
+			const int fd {::shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600)};
+			if (fd < 0)
+			{
+				return unexpected {detail::last_error()};
+			}
+			auto ring {initialize(fd, capacity)};
+			if (!ring)
+			{
+				::shm_unlink(name);
+			}
+			return ring;
+		}
+
+		/* Attaches to a named shared memory object made by create. */
+		static auto open(const char* const name) -> result<shm_variant_ring, std::error_code>
+		{
+			const int fd {::shm_open(name, O_RDWR, 0)};
+			if (fd < 0)
+			{
+				return unexpected {detail::last_error()};
+			}
+			return map(fd);
+		}
+
+		/* Removes the name of a shared memory object, mapped rings stay valid. */
+		static auto unlink(const char* const name) noexcept(true) -> bool
+		{
+			return ::shm_unlink(name) == 0;
+		}
+
+		/* Creates an anonymous ring in a memfd, other processes attach to descriptor() inherited or received over a socket. */
+		static auto anonymous(const std::uint32_t capacity) -> result<shm_variant_ring, std::error_code>
+		{
+			const int fd {::memfd_create("stdex::shm_variant_ring", MFD_CLOEXEC)};
+			if (fd < 0)
+			{
+				return unexpected {detail::last_error()};
+			}
+			return initialize(fd, capacity);
+		}
+
+		/* Attaches to the ring behind a descriptor, which is duplicated. */
+		static auto attach(const int descriptor) -> result<shm_variant_ring, std::error_code>
+		{
+			const int fd {::fcntl(descriptor, F_DUPFD_CLOEXEC, 0)};
+			if (fd < 0)
+			{
+				return unexpected {detail::last_error()};
+			}
+			return map(fd);
+		}
+
+		shm_variant_ring(const shm_variant_ring&) = delete;
+
+		shm_variant_ring(shm_variant_ring&& other) noexcept(true)
+			: header_ {std::exchange(other.header_, nullptr)}, slots_ {std::exchange(other.slots_, nullptr)}, mapped_ {std::exchange(other.mapped_, 0)},
+			capacity_ {std::exchange(other.capacity_, 0)}, dropped_ {std::exchange(other.dropped_, 0)}, fd_ {std::exchange(other.fd_, -1)} { }
+
+		auto operator =(const shm_variant_ring&) -> shm_variant_ring& = delete;
+
+		auto operator =(shm_variant_ring&& other) noexcept(true) -> shm_variant_ring&
+		{
+			std::swap(this->header_, other.header_);
+			std::swap(this->slots_, other.slots_);
+			std::swap(this->mapped_, other.mapped_);
+			std::swap(this->capacity_, other.capacity_);
+			std::swap(this->dropped_, other.dropped_);
+			std::swap(this->fd_, other.fd_);
+			return *this;
+		}
+
+		~shm_variant_ring()
+		{
+			if (this->header_)
+			{
+				::munmap(this->header_, this->mapped_);
+			}
+			if (this->fd_ >= 0)
+			{
+				::close(this->fd_);
+			}
+		}
+
+		[[nodiscard]]
+		auto descriptor() const noexcept(true) -> int
+		{
+			return this->fd_;
+		}
+
+		[[nodiscard]]
+		auto capacity() const noexcept(true) -> std::size_t
+		{
+			return this->capacity_;
+		}
+
+		/* Number of slots this consumer discarded because their discriminator was out of range. */
+		[[nodiscard]]
+		auto dropped() const noexcept(true) -> std::size_t
+		{
+			return this->dropped_;
+		}
+
+		/* Appends the variant, returns false if the ring is full. Producer only. */
+		auto try_push(const value_type& value) noexcept(true) -> bool
+		{
+			const std::uint32_t head {this->header_->head.load(std::memory_order_relaxed)};
+			if (head - this->header_->tail.load(std::memory_order_acquire) == this->capacity_)
+			{
+				return false;
+			}
+			this->write(this->slots_[head & (this->capacity_ - 1)], value);
+			this->header_->head.store(head + 1, std::memory_order_release);
+			notify(this->header_->head, this->header_->reader_waiting);
+			return true;
+		}
+
+		/* Appends the variant, sleeping while the ring is full. Producer only. */
+		auto push(const value_type& value) noexcept(true) -> void
+		{
+			while (!this->try_push(value))
+			{
+				/* A full ring has tail == head - capacity, sleeping only while that holds does not miss a pop after try_push failed. */
+				wait(this->header_->tail, this->header_->writer_waiting, this->header_->head.load(std::memory_order_relaxed) - this->capacity_);
+			}
+		}
+
+		/*
+		 * Removes up to max slots without waiting, writes their variants into out and returns how many were written.
+		 * Slots with an out of range discriminator are removed without writing and counted in dropped(). Consumer only.
+		 */
+		template <typename Out>
+		auto try_pop_batch(Out out, const std::size_t max) noexcept(nothrow_output<Out>) -> std::size_t
+		{
+			const std::uint32_t tail {this->header_->tail.load(std::memory_order_relaxed)};
+			const std::uint32_t available {this->header_->head.load(std::memory_order_acquire) - tail};
+			const std::size_t   taken {std::min<std::size_t>(std::min(available, this->capacity_), max)};
+			std::size_t         count {0};
+			for (std::size_t i {0}; i < taken; ++i)
+			{
+				if (read(this->slots_[(tail + static_cast<std::uint32_t>(i)) & (this->capacity_ - 1)], out))
+				{
+					++count;
+				}
+				else
+				{
+					++this->dropped_;
+				}
+			}
+			if (taken != 0)
+			{
+				this->header_->tail.store(tail + static_cast<std::uint32_t>(taken), std::memory_order_release);
+				notify(this->header_->tail, this->header_->writer_waiting);
+			}
+			return count;
+		}
+
+		/* Removes at least one valid and up to max variants into out, sleeping while the ring is empty. Consumer only. */
+		template <typename Out>
+		auto pop_batch(Out out, const std::size_t max) noexcept(nothrow_output<Out> && std::is_nothrow_copy_constructible_v<Out>) -> std::size_t
+		{
+			std::size_t count {0};
+			while ((count = this->try_pop_batch(out, max)) == 0 && max != 0)
+			{
+				wait(this->header_->head, this->header_->reader_waiting, this->header_->tail.load(std::memory_order_relaxed));
+			}
+			return count;
+		}
+
+		/* Removes the oldest variant if there is one. Consumer only. */
+		auto try_pop() noexcept(true) -> std::optional<value_type>
+		{
+			std::optional<value_type> r { };
+			this->try_pop_batch(&r, 1);
+			return r;
+		}
+
+		/* Removes the oldest variant, sleeping while the ring is empty. Consumer only. */
+		auto pop() noexcept(true) -> value_type
+		{
+			std::optional<value_type> r { };
+			this->pop_batch(&r, 1);
+			return *r;
+		}
+	};
+}
+#endif
+
+#endif
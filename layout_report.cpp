@@ -0,0 +1,64 @@
+/*
+	MIT License
+
+	Copyright 2021 Mario Sieg "pinsrq" <mt3000@gmx.de>
+
+	Permission is hereby granted, free of charge, to any person obtaining a copy
+	of this software and associated documentation files (the "Software"), to deal
+	in the Software without restriction, including without limitation the rights
+	to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+	copies of the Software, and to permit persons to whom the Software is
+	furnished to do so, subject to the following conditions:
+
+	The above copyright notice and this permission notice shall be included in all
+	copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+	IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+	FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+	AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+	LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+	OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+	SOFTWARE.
+ */
+
+
+#include "extended_variant.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// Prints the memory footprint of variant types, add the types to audit to main.
+
+template <typename V>
+static auto print_report(const char* const name) -> void
+{
+	constexpr auto report {stdex::layout_report<V>()};
+	std::cout << name << '\n';
+	std::cout << "  size: " << report.size << ", alignment: " << report.alignment << '\n';
+	std::cout << "  payload: " << report.payload_size << ", tag: " << report.tag_size << ", padding: " << report.padding << '\n';
+	for (std::size_t i {0}; i < report.wasted.size(); ++i)
+	{
+		std::cout << "  alternative " << i << ": wasted " << report.wasted[i] << " bytes";
+		if (report.boxing_candidates[i])
+		{
+			std::cout << ", boxing saves " << report.boxing_savings[i] << " bytes";
+		}
+		std::cout << '\n';
+	}
+}
+
+auto main() -> int
+{
+	print_report<stdex::variant<std::int32_t, float>>("variant<int32_t, float>");
+	print_report<stdex::variant<std::int8_t, double>>("variant<int8_t, double>");
+	print_report<stdex::variant<std::int64_t, double, std::string>>("variant<int64_t, double, string>");
+	print_report<stdex::variant<bool, std::array<std::byte, 256>>>("variant<bool, byte[256]>");
+	print_report<stdex::double_buffered_variant<std::int64_t, std::string>>("double_buffered_variant<int64_t, string>");
+	print_report<stdex::packed_variant<std::int64_t, double, char>>("packed_variant<int64_t, double, char>");
+	print_report<stdex::variant_aligned<64, std::int64_t, double>>("variant_aligned<64, int64_t, double>");
+	return 0;
+}
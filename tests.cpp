@@ -23,14 +23,64 @@
  */
 
 #include "extended_variant.hpp"
+#include "extended_variant_codec.hpp"
+#include "extended_variant_format.hpp"
+#include "extended_variant_json.hpp"
+#include "extended_variant_memo.hpp"
+#include "extended_variant_parallel.hpp"
+#include "extended_variant_shm.hpp"
 
 #include <array>
 #include <cassert>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <tuple>
 #include <vector>
 
+// kernels instantiated at the end of this file
+STDEX_VARIANT_EXTERN(std::int16_t, std::string, double);
+
+template <> struct stdex::type_id<std::int32_t> : std::integral_constant<std::uint32_t, 7> { };
+template <> struct stdex::type_id<std::string> : std::integral_constant<std::uint32_t, 1000> { };
+template <> struct stdex::type_id<double> : std::integral_constant<std::uint32_t, 77777> { };
+
+// stored in two bytes, identifiers above 0x7FFF fail to decode
+struct short_id final
+{
+	std::uint32_t value;
+};
+
+template <>
+struct stdex::value_codec<short_id> final
+{
+	static constexpr std::size_t fixed_size {2};
+
+	static auto size(const short_id&) -> std::size_t
+	{
+		return fixed_size;
+	}
+
+	static auto write(std::byte* const out, const short_id& id) -> void
+	{
+		out[0] = static_cast<std::byte>(id.value);
+		out[1] = static_cast<std::byte>(id.value >> 8);
+	}
+
+	static auto read(const std::byte* const first, const std::size_t size) -> std::optional<short_id>
+	{
+		const auto value {std::to_integer<std::uint32_t>(first[0]) | std::to_integer<std::uint32_t>(first[1]) << 8};
+		return size == fixed_size && value <= 0x7FFF ? std::optional<short_id> {short_id {value}} : std::nullopt;
+	}
+};
+
+// places the discriminator before the storage
+struct tag_first_policy : stdex::variant_policy
+{
+	static constexpr stdex::tag_placement placement {stdex::tag_placement::before};
+};
+
 // std extensions
 namespace stdex
 {
@@ -56,6 +106,15 @@ namespace stdex
 		// std variant
 		static_assert(std::is_same_v<variant<std::int8_t, float, std::string>::detail::std_variant, std::variant<std::int8_t, float, std::string>>);
 
+		// type list
+		static_assert(std::is_same_v<type_list<int, float, char>::at<1>, float>);
+		static_assert(type_list<int, float, char>::index_of<char> == 2);
+		static_assert(!type_list<int, float>::contains<char>);
+		static_assert(std::is_same_v<unique_t<type_list<int, float, int, char, float>>, type_list<int, float, char>>);
+		static_assert(std::is_same_v<type_list<int, float, char>::filter<std::is_integral>, type_list<int, char>>);
+		static_assert(std::is_same_v<type_list<int, float>::map<std::add_pointer_t>, type_list<int*, float*>>);
+		static_assert(std::is_same_v<variant<std::int8_t, float>::detail::alternative<1>, float>);
+
 		// index of
 		static_assert(variant<std::int8_t, float, std::string>::index_of<std::int8_t>() == 0);
 		static_assert(variant<std::int8_t, float, std::string>::index_of<float>() == 1);
@@ -70,10 +129,95 @@ namespace stdex
 		static_assert(std::is_same_v<detail::discriminator<std::numeric_limits<std::uint32_t>::max()>::type, std::uint32_t>);
 		static_assert(std::is_same_v<detail::discriminator<static_cast<std::size_t>(std::numeric_limits<std::uint32_t>::max()) + 1>::type, std::size_t>);
 		static_assert(std::is_same_v<detail::discriminator<std::numeric_limits<std::size_t>::max()>::type, std::size_t>);
+
+		// storage
+		static_assert(variant<std::int32_t, std::int64_t>::detail::storage_size == 8);
+		static_assert(double_buffered_variant<std::int32_t, std::int64_t>::detail::storage_size == 16);
+		static_assert(double_buffered_variant<std::array<char, 3>, std::int16_t>::detail::storage_size == 8);
+		static_assert(sizeof(variant<std::int32_t, std::int64_t>) == 16);
+		static_assert(sizeof(double_buffered_variant<std::int32_t, std::int64_t>) == 24);
+		static_assert(sizeof(variant<std::array<char, 3>, std::int16_t>) == 4);
+
+		// alignment and layout
+		static_assert(alignof(variant_aligned<64, std::int32_t, double>) == 64);
+		static_assert(sizeof(variant_aligned<64, std::int32_t, double>) == 64);
+		static_assert(variant_aligned<2, std::int32_t, double>::detail::storage_align == alignof(double));
+		static_assert(sizeof(packed_variant<double, char>) == 9);
+		static_assert(alignof(packed_variant<double, char>) == 1);
+		static_assert(sizeof(std::array<packed_variant<std::int32_t, std::int16_t>, 4>) == 20);
+		static_assert(sizeof(basic_variant<tag_first_policy, double, char>) == 16);
+		static_assert(basic_variant<tag_first_policy, double, char>::detail::tag_first);
+
+		// default tag placement
+		static_assert(!variant<double, char>::detail::tag_first);
+		static_assert(sizeof(variant<std::array<char, 5>, std::int32_t>) < sizeof(basic_variant<tag_first_policy, std::array<char, 5>, std::int32_t>));
+		static_assert(sizeof(variant<double, char>) == 16);
+		static_assert(sizeof(variant<std::array<char, 3>, std::int16_t>) == 4);
+		static_assert(sizeof(variant<std::array<char, 5>, std::int32_t>) == 8);
+		static_assert(sizeof(variant_aligned<64, std::array<char, 64>, double>) == 128);
+		static_assert(sizeof(basic_variant<tag_first_policy, std::array<char, 5>, std::int32_t>) == 12);
+		static_assert(sizeof(std::array<variant<std::int32_t, std::int16_t>, 16>) == 16 * 8);
+		static_assert(sizeof(std::array<packed_variant<std::int32_t, std::int16_t>, 16>) == 16 * 5);
+		static_assert(sizeof(std::array<double_buffered_variant<std::int32_t, std::int16_t>, 16>) == 16 * 12);
+
+		// layout report
+		static constexpr auto report {layout_report<variant<std::int8_t, std::array<char, 64>, double>>()};
+		static_assert(report.size == 65 + 7);
+		static_assert(report.alignment == 8);
+		static_assert(report.payload_size == 64);
+		static_assert(report.tag_size == 1);
+		static_assert(report.padding == 7);
+		static_assert(report.wasted[0] == 71 && report.wasted[1] == 8 && report.wasted[2] == 64);
+		static_assert(report.boxing_savings[1] == 56 && report.boxing_savings[0] == 0);
+		static_assert(!report.boxing_candidates[0] && report.boxing_candidates[1] && !report.boxing_candidates[2]);
+
+		// converting constructor
+		static_assert(detail::select_alternative<int, float, int>() == 1);
+		static_assert(detail::select_alternative<const int&, float, int>() == 1);
+		static_assert(detail::select_alternative<float, int, double>() == 1);
+		static_assert(detail::select_alternative<const char*, int, std::string>() == 1);
+		static_assert(!std::is_constructible_v<variant<float, std::string>, double>);
+		static_assert(!std::is_constructible_v<variant<std::int8_t, std::string>, int>);
+		static_assert(!std::is_constructible_v<variant<long, long long>, int>);
+		static_assert(!std::is_convertible_v<double, variant<float, int>>);
+		static_assert(std::is_convertible_v<int, variant<float, int>>);
+
+		// copying and moving
+		static_assert(std::is_copy_constructible_v<variant<int, std::string>> && std::is_copy_assignable_v<variant<int, std::string>>);
+		static_assert(!std::is_copy_constructible_v<variant<int, std::unique_ptr<int>>> && !std::is_copy_assignable_v<variant<int, std::unique_ptr<int>>>);
+		static_assert(std::is_move_constructible_v<variant<int, std::unique_ptr<int>>> && std::is_move_assignable_v<variant<int, std::unique_ptr<int>>>);
+		static_assert(!std::is_move_constructible_v<double_buffered_variant<int, std::mutex>> && !std::is_move_assignable_v<double_buffered_variant<int, std::mutex>>);
+
+		// result
+		static_assert(sizeof(result<std::int32_t, std::int8_t, std::int16_t, std::uint32_t>) == 8);
+		static_assert(sizeof(expected<double, std::int32_t>) == sizeof(variant<double, std::int32_t>));
+		static_assert(std::is_same_v<expected<float, int>::discriminator_v, std::uint8_t>);
+		static_assert(result<int, int, float>::detail::error_index<int>() == 1);
+		static_assert(result<int, int, float>::detail::error_index<float>() == 2);
 	};
 }
 
+// visits with the dispatch strategy S
+template <const stdex::dispatch_strategy S>
+struct dispatch_policy : stdex::variant_policy
+{
+	static constexpr stdex::dispatch_strategy dispatch {S};
+};
+
+// visits every alternative of a variant with the strategy S
+template <const stdex::dispatch_strategy S, std::size_t... Is>
+auto visits_every_alternative(std::index_sequence<Is...>) -> bool
+{
+	using mapping = stdex::basic_variant<dispatch_policy<S>, std::integral_constant<std::size_t, Is>...>;
+	static_assert(mapping::detail::dispatch == S);
+	return ((mapping {std::in_place_index<Is>}.visit([](const auto x) { return decltype(x)::value; }) == Is) && ...);
+}
+
 using stdex::variant;
+using stdex::double_buffered_variant;
+using stdex::result;
+using stdex::expected;
+using stdex::unexpected;
 
 auto main() -> int
 {
@@ -163,7 +307,747 @@ auto main() -> int
 		assert(val == 125);
 	}
 
+	/* copying and moving: */
+	{
+		variant<int, std::string> a {std::in_place_type<std::string>, "extended variant"};
+		assert(a.index() == 1);
+		assert(a.get<std::string>() == "extended variant");
+
+		variant<int, std::string> b {a};
+		assert(b.holds_alternative<std::string>());
+		assert(b.get_unchecked<1>() == "extended variant");
+
+		variant<int, std::string> c {std::move(b)};
+		assert(c.get_unchecked<std::string>() == "extended variant");
+
+		a = variant<int, std::string> {std::in_place_index<0>, 3};
+		assert(a.holds_value<int>(3));
+		a = c;
+		assert(a.get<std::string>() == "extended variant");
+	}
+
+	/* emplacing: */
+	{
+		variant<int, std::string> a { };
+		assert(a.emplace<std::string>(3, 'x') == "xxx");
+		assert(a.holds_alternative<std::string>());
+		assert(a.emplace<0>(4) == 4);
+		assert(a.holds_value<int>(4));
+
+		struct throwing_move final
+		{
+			std::string text;
+
+			throwing_move(std::string t) : text {std::move(t)} { }
+			throwing_move(const throwing_move&) = default;
+			throwing_move(throwing_move&& other) noexcept(false) : text {std::move(other.text)} { }
+		};
+
+		double_buffered_variant<int, throwing_move> b { };
+		assert(b.emplace<throwing_move>("first").text == "first");
+		double_buffered_variant<int, throwing_move> c {std::in_place_type<throwing_move>, "second"};
+		b = c;
+		assert(b.get_unchecked<throwing_move>().text == "second");
+		assert(c.get_unchecked<throwing_move>().text == "second");
+		b = double_buffered_variant<int, throwing_move> {std::in_place_index<0>, 5};
+		assert(b.holds_value<int>(5));
+		b = std::move(c);
+		assert(b.get_unchecked<1>().text == "second");
+	}
+
+	/* converting: */
+	{
+		variant<int, double, std::string> a {3};
+		assert(a.holds_value<int>(3));
+		variant<int, double, std::string> b {2.5F};
+		assert(b.holds_alternative<double>());
+		variant<int, double, std::string> c {"text"};
+		assert(c.get<std::string>() == "text");
+		c = 4.0;
+		assert(c.holds_value<double>(4.0));
+
+		static int moves {0};
+		static int copies {0};
+
+		struct counted final
+		{
+			counted() = default;
+			counted(const counted&) { ++copies; }
+			counted(counted&&) noexcept { ++moves; }
+		};
+
+		counted x { };
+		variant<int, counted> d {std::move(x)};
+		assert(d.holds_alternative<counted>());
+		assert(moves == 1 && copies == 0);
+		variant<int, counted> e {x};
+		assert(e.holds_alternative<counted>());
+		assert(moves == 1 && copies == 1);
+		e = std::move(x);
+		assert(moves == 2 && copies == 1);
+	}
+
+	/* packed and tag first: */
+	{
+		std::array<stdex::packed_variant<double, char>, 3> a { };
+		a[1] = 2.5;
+		a[2].emplace<char>('x');
+		assert(a[0].holds_value(0.0));
+		assert(a[1].get<double>() == 2.5);
+		assert(a[2].get_or_default<char>() == 'x');
+		assert(a[1].visit([](const double x) { return x; }, [](const char x) { return static_cast<double>(x); }) == 2.5);
+		a[1].visit([](double& x) { x *= 2.0; }, [](char&) { });
+		assert(a[1].get<double>() == 5.0);
+		const auto b {a[1]};
+		assert(b.get_unchecked<double>() == 5.0);
+
+		/* Trivially copyable alternatives need no default constructor. */
+		struct point final
+		{
+			explicit point(const std::int32_t x) noexcept(true) : x {x} { }
+			std::int32_t x;
+		};
+		stdex::packed_variant<char, point> p {point {3}};
+		p.visit([](char&) { }, [](point& x) { x.x += 1; });
+		assert(std::as_const(p).get_unchecked<point>().x == 4);
+
+		stdex::basic_variant<tag_first_policy, int, std::string> c {"tag first"};
+		assert(c.index() == 1);
+		assert(c.get<std::string>() == "tag first");
+		c = 3;
+		assert(c.holds_value(3));
+	}
+
+	/* visiting: */
+	{
+		variant<int, float, std::string> a {std::in_place_type<float>, 1.5F};
+		[[maybe_unused]] const auto name = [](const variant<int, float, std::string>& v)
+		{
+			return v.visit
+			(
+				[](const int) { return "integer"; },
+				[](const float) { return "floating point"; },
+				[](const std::string&) { return "string"; }
+			);
+		};
+		assert(std::string {name(a)} == "floating point");
+		a.emplace<std::string>("text");
+		assert(std::string {name(a)} == "string");
+
+		// exact beats generic beats converting, regardless of order
+		[[maybe_unused]] const auto rank = [](const variant<int, float, std::string>& v)
+		{
+			return v.visit
+			(
+				[](const double) { return 2; },
+				[](const auto&) { return 1; },
+				[](const int) { return 0; }
+			);
+		};
+		assert(rank(variant<int, float, std::string> {std::in_place_type<int>, 1}) == 0);
+		assert(rank(variant<int, float, std::string> {std::in_place_type<float>, 1.F}) == 1);
+		assert(rank(variant<int, float, std::string> {std::in_place_type<std::string>}) == 1);
+
+		variant<int, float> b {std::in_place_type<float>, 2.F};
+		b.visit([](int& x) { x = 0; }, [](float& x) { x += 1.F; });
+		assert(b.get_unchecked<float>() == 3.F);
+		assert(b.visit([](const double x) { return x; }) == 3.0);
+
+		static_assert(stdex::detail::handler_set<stdex::visit_mode::relaxed, void (*)(double)>::index<float&> == 0);
+		static_assert(stdex::detail::handler_set<stdex::visit_mode::strict, void (*)(double)>::index<float&> == 1);
+		static_assert(stdex::detail::handler_set<stdex::visit_mode::strict, void (*)(double), void (*)(float)>::index<float&> == 1);
+		assert(b.visit<stdex::visit_mode::strict>([](const int) { return 0; }, [](const float) { return 1; }) == 1);
+	}
+
+	/* dispatch strategies: */
+	{
+		static_assert(variant<int, float>::detail::dispatch == stdex::dispatch_strategy::if_chain);
+		static_assert(stdex::detail::select_dispatch(64) == stdex::dispatch_strategy::switch_case);
+		static_assert(stdex::detail::select_dispatch(65) == stdex::dispatch_strategy::jump_table);
+
+		assert(visits_every_alternative<stdex::dispatch_strategy::if_chain>(std::make_index_sequence<5> { }));
+		assert(visits_every_alternative<stdex::dispatch_strategy::switch_case>(std::make_index_sequence<20> { }));
+		assert(visits_every_alternative<stdex::dispatch_strategy::jump_table>(std::make_index_sequence<20> { }));
+		assert(visits_every_alternative<stdex::dispatch_strategy::binary_search>(std::make_index_sequence<20> { }));
+	}
+
+	/* matching: */
+	{
+		[[maybe_unused]] const auto classify = [](const variant<int, float, std::string>& v) -> std::string
+		{
+			return stdex::match(v)
+			(
+				stdex::when<int>([](const int x) { return x < 0; }) >> [](const int) { return std::string {"negative"}; },
+				stdex::when<std::string>([](const std::string& x) { return x.empty(); }) >> [](const std::string&) { return std::string {"empty"}; },
+				stdex::when<int>() >> [](const int x) { return std::to_string(x); },
+				stdex::when<std::string>() >> [](const std::string& x) { return x; },
+				stdex::otherwise >> [] { return std::string {"other"}; }
+			);
+		};
+
+		assert(classify(variant<int, float, std::string> {std::in_place_type<int>, -3}) == "negative");
+		assert(classify(variant<int, float, std::string> {std::in_place_type<int>, 3}) == "3");
+		assert(classify(variant<int, float, std::string> {std::in_place_type<float>, 1.F}) == "other");
+		assert(classify(variant<int, float, std::string> {std::in_place_type<std::string>}) == "empty");
+		assert(classify(variant<int, float, std::string> {std::in_place_type<std::string>, "text"}) == "text");
+
+		variant<int, float> a {std::in_place_type<float>, 2.F};
+		stdex::match(a)
+		(
+			stdex::when<float>([](const float x) { return x > 1.F; }) >> [](float& x) { x *= 2.F; },
+			stdex::when<int>() >> [](int& x) { ++x; }
+		);
+		assert(a.get_unchecked<float>() == 4.F);
+	}
+
+	/* open variant: */
+	{
+		using stdex::open_variant;
+		using stdex::type_registry;
+
+		struct large final
+		{
+			std::array<std::int64_t, 16> values;
+		};
+
+		open_variant<> a { };
+		assert(!a.has_value());
+		a = 3;
+		assert(a.holds_alternative<int>());
+		assert(a.get<int>() == 3);
+		assert(a.get_if<float>() == nullptr);
+		assert(a.type_id() == type_registry::id<int>());
+		assert(type_registry::id<int>() != type_registry::id<float>());
+
+		a.emplace<std::string>("open variant");
+		open_variant<> b {a};
+		assert(b.get_unchecked<std::string>() == "open variant");
+
+		b.emplace<large>().values[3] = 7;
+		static_assert(!open_variant<>::detail::stored_inline<large>);
+		open_variant<> c {b};
+		open_variant<> d {std::move(b)};
+		assert(!b.has_value());
+		assert(c.get_if<large>()->values[3] == 7);
+		assert(d.get_if<large>()->values[3] == 7);
+		d = a;
+		assert(d.get<std::string>() == "open variant");
+		c = std::move(d);
+		assert(c.get_unchecked<std::string>() == "open variant");
+
+		const variant<int, std::string> closed {"closed"};
+		const open_variant<> e {closed};
+		assert(e.get<std::string>() == "closed");
+		const open_variant<> f {variant<int, std::string> {5}};
+		assert(f.get<int>() == 5);
+
+		struct never_held final { };
+		[[maybe_unused]] const auto registered {type_registry::size()};
+		assert(!f.holds_alternative<never_held>() && f.get_if<never_held>() == nullptr);
+		assert(type_registry::size() == registered && type_registry::find<never_held>() == 0);
+
+		open_variant<> g { };
+		*g.emplace<std::unique_ptr<int>>(std::make_unique<int>(9)) += 1;
+		const open_variant<> h {std::move(g)};
+		assert(**h.get_if<std::unique_ptr<int>>() == 10);
+	}
+
+	/* comparing and memoizing: */
+	{
+		using key = variant<int, std::string>;
+		assert(key {1} == key {1});
+		assert(key {1} != key {2});
+		assert(key {1} != key {"1"});
+		assert(std::hash<key> { }(key {1}) == std::hash<key> { }(key {1}));
+
+		stdex::variant_memo<key, std::size_t> memo {2, 1};
+		std::size_t calls {0};
+		[[maybe_unused]] const auto length = [&calls](const key& k) -> std::size_t
+		{
+			++calls;
+			return k.visit([](const int x) { return std::to_string(x).size(); }, [](const std::string& x) { return x.size(); });
+		};
+		assert(memo.get_or_compute(key {"abc"}, length) == 3);
+		assert(memo.get_or_compute(key {"abc"}, length) == 3);
+		assert(memo.get_or_compute(key {1234}, length) == 4);
+		assert(calls == 2);
+		assert(memo.hits() == 1);
+
+		/* Every alternative has its own capacity, the referenced entry survives eviction. */
+		assert(memo.get_or_compute(key {"de"}, length) == 2);
+		assert(memo.find(key {"abc"}) == 3);
+		assert(memo.get_or_compute(key {"fghi"}, length) == 4);
+		assert(memo.size() == 3);
+		assert(memo.find(key {"abc"}) == 3);
+		assert(!memo.find(key {"de"}));
+		assert(memo.find(key {1234}) == 4);
+
+		memo.clear();
+		assert(memo.size() == 0 && memo.hits() == 0);
+
+		/* Zero capacity and shards still hold and evict one entry. */
+		stdex::variant_memo<key, std::size_t> tiny {0, 0};
+		[[maybe_unused]] const auto first {tiny.get_or_compute(key {"ab"}, length)};
+		[[maybe_unused]] const auto second {tiny.get_or_compute(key {"cde"}, length)};
+		assert(first == 2 && second == 3 && tiny.size() == 1);
+	}
+
+	/* explicit instantiation: */
+	{
+		using message = variant<std::int16_t, std::string, double>;
+		const message a {"extern"};
+		message       b {a};
+		assert(a == b);
+		b = message {2.5};
+		assert(a != b);
+		assert(std::hash<message> { }(a) == std::hash<message> { }(message {"extern"}));
+	}
+
+	/* folding: */
+	{
+		std::vector<variant<int, std::string>> values { };
+		for (int i {0}; i < 100000; ++i)
+		{
+			values.emplace_back(i % 7 < 5 ? variant<int, std::string> {i} : variant<int, std::string> {"ab"});
+		}
+		std::int64_t ints {0};
+		std::size_t  chars {0};
+		for (const auto& value : values)
+		{
+			ints  += value.holds_alternative<int>() ? value.get_unchecked<int>() : 0;
+			chars += value.holds_alternative<std::string>() ? value.get_unchecked<std::string>().size() : 0;
+		}
+
+		[[maybe_unused]] const auto [a, b] = stdex::fold_by_type
+		(
+			values,
+			std::tuple<std::int64_t, std::size_t> {0, 0},
+			[](const std::int64_t acc, const int x) { return acc + x; },
+			[](const std::size_t acc, const std::string& x) { return acc + x.size(); }
+		);
+		assert(a == ints && b == chars);
+
+		[[maybe_unused]] const auto [c, d] = stdex::fold_by_type_parallel
+		(
+			values,
+			std::tuple<std::int64_t, std::size_t> {0, 0},
+			[](const auto x, const auto y) { return x + y; },
+			[](const std::int64_t acc, const int x) { return acc + x; },
+			[](const std::size_t acc, const std::string& x) { return acc + x.size(); }
+		);
+		assert(c == ints && d == chars);
+
+		const auto counts {stdex::fold_by_type(values, std::tuple<int, int> {0, 0}, [](const int acc, const auto&) { return acc + 1; })};
+		assert(std::get<0>(counts) + std::get<1>(counts) == 100000);
+	}
+
+	/* columns: */
+	{
+		std::vector<variant<std::int64_t, double, bool, std::string>> a {std::int64_t {4}, 1.5, true, "text", 2.5, false};
+		assert(a[1].get_or_default<double>() == 1.5);
+		assert(a[0].get_or_default<double>() == 0.0);
+		assert(a[2].get_or_custom_value<bool>(false));
+		assert(a[5].get_or_custom_value<bool>(true) == false);
+		assert(a[3].get_or_custom_value<bool>(true));
+		assert(a[3].get_or_custom_value<std::int64_t>(-1) == -1);
+
+		std::vector<double> b (a.size());
+		assert(stdex::get_or_custom_value_column<double>(a, b.begin(), -1.0) == b.end());
+		assert((b == std::vector<double> {-1.0, 1.5, -1.0, -1.0, 2.5, -1.0}));
+
+		std::array<std::int64_t, 6> c { };
+		stdex::get_or_default_column<std::int64_t>(a, c.data());
+		assert((c == std::array<std::int64_t, 6> {4, 0, 0, 0, 0, 0}));
+	}
+
+	/* formatting: */
+	{
+		char buffer[64];
+		const auto text {[&](const auto& v) { return std::string {buffer, stdex::format_to(buffer, v)}; }};
+		assert(text(variant<std::int64_t, double, bool, std::string, std::nullptr_t> {std::numeric_limits<std::int64_t>::min()}) == "-9223372036854775808");
+		assert(text(variant<std::uint8_t, double> {std::uint8_t {7}}) == "7");
+		assert(text(variant<std::uint32_t, double> {1234567u}) == "1234567");
+		assert(text(variant<std::int32_t, double> {0.1}) == "0.1");
+		assert(text(variant<bool, std::string> {false}) == "false");
+		assert(text(variant<std::nullptr_t, std::string> {std::string {"text"}}) == "text");
+		assert(text(variant<std::nullptr_t, variant<char, int>> {variant<char, int> {'x'}}) == "x");
+
+		std::string appended { };
+		stdex::format_to(std::back_inserter(appended), variant<int, double> {-42});
+		assert(appended == "-42");
+
+		char       bounded[4];
+		[[maybe_unused]] const auto r {stdex::format_to_n(bounded, sizeof(bounded), variant<int, std::string> {std::string {"truncated"}})};
+		assert(r.out == std::end(bounded) && r.size == 9 && std::string(bounded, 4) == "trun");
+	}
+
+	/* encoding: */
+	{
+		std::vector<std::byte> bytes { };
+		stdex::encode(variant<std::int32_t, std::string, double> {std::int32_t {-5}}, bytes);
+		stdex::encode(variant<std::int32_t, std::string, double> {std::string {"skipped"}}, bytes);
+		stdex::encode(variant<std::int32_t, std::string, double> {2.5}, bytes);
+
+		/* The reader reordered and dropped alternatives, stable ids still find the right ones. */
+		using reader [[maybe_unused]] = variant<double, std::int32_t>;
+		[[maybe_unused]] const std::byte* first {bytes.data()};
+		[[maybe_unused]] const std::byte* last {bytes.data() + bytes.size()};
+		assert(stdex::decode<reader>(first, last).value().get_or_default<std::int32_t>() == -5);
+		assert(stdex::decode<reader>(first, last).error() == stdex::decode_errc::unknown_id);
+		assert(stdex::decode<reader>(first, last).value().get_or_default<double>() == 2.5);
+		assert(first == last && stdex::decode<reader>(first, last).error() == stdex::decode_errc::truncated);
+
+		/* Without ids the discriminator is the tag. */
+		bytes.clear();
+		stdex::encode(variant<char, std::int64_t> {std::int64_t {1} << 40}, bytes);
+		first = bytes.data();
+		assert((stdex::decode<variant<char, std::int64_t>>(first, bytes.data() + bytes.size()).value().get_or_default<std::int64_t>() == std::int64_t {1} << 40));
+
+		/* Trivially copyable payloads need no default constructor. */
+		struct point final
+		{
+			explicit point(const std::int32_t value) : x {value} { }
+			std::int32_t x;
+		};
+		bytes.clear();
+		stdex::encode(variant<char, point> {point {-3}}, bytes);
+		first = bytes.data();
+		assert((stdex::decode<variant<char, point>>(first, bytes.data() + bytes.size()).value().get_unchecked<point>().x == -3));
+
+		/* A tenth varint byte above one does not fit 64 bits. */
+		std::array<std::byte, 10> overlong { };
+		overlong.fill(std::byte {0xFF});
+		overlong.back() = std::byte {2};
+		first = overlong.data();
+		assert(stdex::decode<reader>(first, overlong.data() + overlong.size()).error() == stdex::decode_errc::truncated);
+	}
+
+	/* batch encoding: */
+	{
+		using writer = variant<std::int32_t, std::string, double>;
+		std::vector<writer> batch { };
+		for (std::int32_t i {0}; i < 100; ++i)
+		{
+			batch.emplace_back(i % 4 == 3 ? writer {std::to_string(i)} : i % 4 == 2 ? writer {i * 0.5} : writer {1000 - i});
+		}
+		const auto plain {stdex::serialize_batch(batch)};
+		const auto delta {stdex::serialize_batch(batch, stdex::batch_encoding::delta_varint)};
+		assert(delta.size() < plain.size());
+
+		for (const auto* bytes : {&plain, &delta})
+		{
+			std::vector<writer> all { };
+			[[maybe_unused]] const std::byte*    first {bytes->data()};
+			assert(stdex::deserialize_batch(first, bytes->data() + bytes->size(), all).value() == batch.size());
+			assert(first == bytes->data() + bytes->size() && all == batch);
+
+			/* Strings are unknown to the reader and skipped. */
+			std::vector<variant<double, std::int32_t>> numbers { };
+			first = bytes->data();
+			assert(stdex::deserialize_batch(first, bytes->data() + bytes->size(), numbers).value() == 75);
+			assert(numbers[0].get_or_default<std::int32_t>() == 1000 && numbers[2].get_or_default<double>() == 1.0);
+		}
+
+		std::vector<writer> none { };
+		[[maybe_unused]] const std::byte*    first {plain.data()};
+		assert(stdex::deserialize_batch(first, plain.data() + plain.size() / 2, none).error() == stdex::decode_errc::truncated);
+
+		/* Custom fixed sizes are honoured, and a failing payload leaves the container as it was. */
+		using ids = variant<std::int16_t, short_id>;
+		const std::vector<ids> mixed {ids {std::int16_t {1}}, ids {short_id {5}}, ids {std::int16_t {2}}, ids {short_id {0x8000}}};
+		const auto             encoded {stdex::serialize_batch(mixed)};
+		assert(encoded.size() == 1 + 1 + 4 + 1 + (2 + 4) + (2 + 4));
+		std::vector<ids> decoded {ids {std::int16_t {7}}};
+		first = encoded.data();
+		assert(stdex::deserialize_batch(first, encoded.data() + encoded.size(), decoded).error() == stdex::decode_errc::invalid_payload);
+		assert(decoded.size() == 1 && decoded[0].get_or_default<std::int16_t>() == 7);
+
+		/* A tag whose block is missing fails without appending. */
+		using numbers = variant<std::int16_t, float>;
+		auto missing {stdex::serialize_batch(std::vector<numbers> {numbers {std::int16_t {1}}, numbers {std::int16_t {2}}, numbers {2.5F}})};
+		assert(missing.size() == 1 + 1 + 3 + 1 + (2 + 4) + (2 + 4));
+		missing[5] = std::byte {1};
+		missing.resize(missing.size() - (2 + 4));
+		std::vector<numbers> kept {numbers {std::int16_t {7}}};
+		first = missing.data();
+		assert(stdex::deserialize_batch(first, missing.data() + missing.size(), kept).error() == stdex::decode_errc::truncated);
+		assert(kept.size() == 1 && kept[0].get_or_default<std::int16_t>() == 7);
+	}
+
+#if defined(__linux__)
+	/* shared memory ring: */
+	{
+		using ring = stdex::shm_variant_ring<std::int32_t, double>;
+		auto producer {ring::anonymous(6)};
+		assert(producer && producer.value().capacity() == 8);
+		auto consumer {ring::attach(producer.value().descriptor())};
+		assert(consumer && !ring::attach(-1));
+
+		std::thread writer {[&producer]
+		{
+			for (std::int32_t i {0}; i < 10000; ++i)
+			{
+				producer.value().push(i % 2 ? ring::value_type {i} : ring::value_type {i * 0.5});
+			}
+		}};
+		std::vector<ring::value_type> received { };
+		while (received.size() < 10000)
+		{
+			consumer.value().pop_batch(std::back_inserter(received), 64);
+		}
+		writer.join();
+		for (std::int32_t i {0}; i < 10000; ++i)
+		{
+			assert(i % 2 ? received[i].get_or_default<std::int32_t>() == i : received[i].get_or_default<double>() == i * 0.5);
+		}
+		[[maybe_unused]] const auto leftover {consumer.value().try_pop()};
+		assert(!leftover && consumer.value().dropped() == 0);
+
+		/* A single slot ring is full after every push, so the producer sleeps each time the consumer has not popped yet. */
+		auto single {ring::anonymous(1)};
+		assert(single && single.value().capacity() == 1);
+		auto drain {ring::attach(single.value().descriptor())};
+		std::thread single_writer {[&single]
+		{
+			for (std::int32_t i {0}; i < 10000; ++i)
+			{
+				single.value().push(ring::value_type {i});
+			}
+		}};
+		for (std::int32_t i {0}; i < 10000; ++i)
+		{
+			[[maybe_unused]] const auto popped {drain.value().pop()};
+			assert(popped.get_or_default<std::int32_t>() == i);
+		}
+		single_writer.join();
+
+		const std::string name {"/stdex_ring_" + std::to_string(::getpid())};
+		auto              named {ring::create(name.c_str(), 4)};
+		[[maybe_unused]] const auto duplicate {ring::create(name.c_str(), 4)};
+		assert(named && !duplicate);
+		[[maybe_unused]] const bool pushed {named.value().try_push(ring::value_type {1.5})};
+		assert(pushed);
+		[[maybe_unused]] const auto opened {ring::open(name.c_str()).value().pop()};
+		assert(opened.get_or_default<double>() == 1.5);
+		[[maybe_unused]] const bool unlinked {ring::unlink(name.c_str())};
+		assert(unlinked && !ring::open(name.c_str()));
+		assert(!stdex::shm_variant_ring<std::int32_t>::attach(named.value().descriptor()));
+	}
+#endif
+
+	/* extracting: */
+	{
+		std::vector<variant<std::int64_t, double, std::string>> a { };
+		for (std::int64_t i {0}; i < 70; ++i)
+		{
+			a.emplace_back(i % 3 == 0 ? variant<std::int64_t, double, std::string> {i} : variant<std::int64_t, double, std::string> {"skip"});
+		}
+		std::vector<std::int64_t>  values (a.size());
+		[[maybe_unused]] std::array<std::uint64_t, 2> mask { };
+		assert(stdex::extract<std::int64_t>(a, values.data(), mask.data()) == 24);
+		for (std::size_t i {0}; i < 24; ++i)
+		{
+			assert(values[i] == static_cast<std::int64_t>(i * 3));
+		}
+		for (std::size_t i {0}; i < a.size(); ++i)
+		{
+			assert(((mask[i / 64] >> (i % 64)) & 1) == (i % 3 == 0));
+		}
+
+		std::vector<std::string> strings (a.size());
+		assert(stdex::extract<std::string>(a, strings.data(), mask.data()) == 46);
+		assert(strings[45] == "skip" && (mask[1] & 1) == 1);
+	}
+
+	/* compacting: */
+	{
+		std::vector<variant<int, std::string, float>> a {1, "heartbeat", 2, 3.F, "heartbeat", "heartbeat", 4};
+		assert(stdex::erase_alternative<std::string>(a) == 3);
+		assert(a.size() == 4);
+		assert(a[0].get<int>() == 1 && a[1].get<int>() == 2 && a[2].get<float>() == 3.F && a[3].get<int>() == 4);
+		assert((stdex::keep_alternatives<float, std::string>(a) == 3));
+		assert(a.size() == 1 && a[0].holds_alternative<float>());
+
+		std::vector<variant<std::uint8_t, double>> b { };
+		for (int i {0}; i < 64; ++i)
+		{
+			b.emplace_back(i % 3 == 0 ? variant<std::uint8_t, double> {static_cast<std::uint8_t>(i)} : variant<std::uint8_t, double> {static_cast<double>(i)});
+		}
+		assert(stdex::erase_alternative<std::uint8_t>(b) == 22);
+		for (std::size_t i {0}; i < b.size(); ++i)
+		{
+			assert(b[i].get<double>() == static_cast<double>(i + i / 2 + 1));
+		}
+	}
+
+	/* widening and narrowing: */
+	{
+		using narrow_v = variant<int, std::string>;
+		using wide_v   = variant<float, std::string, int>;
+
+		static_assert(stdex::detail::index_remap<narrow_v, wide_v>::value[0] == 2);
+		static_assert(stdex::detail::index_remap<wide_v, narrow_v>::value[0] == stdex::detail::unmapped);
+
+		const narrow_v a {"widened"};
+		const auto     b {stdex::widen<wide_v>(a)};
+		assert(b.get<std::string>() == "widened");
+		assert(stdex::widen<wide_v>(narrow_v {3}).get<int>() == 3);
+
+		assert(stdex::narrow<narrow_v>(b)->get<std::string>() == "widened");
+		assert(!stdex::narrow<narrow_v>(wide_v {2.F}));
+		assert(stdex::narrow<narrow_v>(wide_v {std::in_place_type<int>, 4})->get<int>() == 4);
+
+		using small_v = stdex::packed_variant<std::uint8_t, double>;
+		using large_v = stdex::variant_aligned<32, double, std::int64_t, std::uint8_t>;
+		static_assert(stdex::detail::index_remap<small_v, large_v>::bytewise);
+		assert(stdex::widen<large_v>(small_v {2.5}).get<double>() == 2.5);
+		assert(stdex::widen<large_v>(small_v {std::uint8_t {7}}).get<std::uint8_t>() == 7);
+		assert(stdex::narrow<small_v>(large_v {std::int64_t {1}}) == std::nullopt);
+		assert(stdex::narrow<small_v>(large_v {std::uint8_t {9}})->get<std::uint8_t>() == 9);
+	}
+
+	/* flattening: */
+	{
+		using inner_a = variant<int, std::string>;
+		using inner_b = variant<float, int>;
+		using nested  = variant<inner_a, inner_b, char>;
+		static_assert(std::is_same_v<stdex::flatten_t<nested>, variant<int, std::string, float, char>>);
+		static_assert(stdex::detail::nested_slots<nested>::count == 5);
+		static_assert(stdex::detail::nested_slots<nested>::flat_index<3> == 0);
+
+		const nested a {inner_b {std::in_place_type<int>, 7}};
+		const auto   b {stdex::flatten(a)};
+		assert(b.get<int>() == 7);
+		assert(stdex::flatten(nested {inner_a {"flat"}}).get<std::string>() == "flat");
+		assert(stdex::flatten(nested {'x'}).get<char>() == 'x');
+
+		[[maybe_unused]] const auto describe = [](const nested& n)
+		{
+			return stdex::visit_flat<stdex::visit_mode::strict>
+			(
+				n,
+				[](const int x) { return x; },
+				[](const std::string& x) { return static_cast<int>(x.size()); },
+				[](const float) { return -1; },
+				[](const char) { return -2; }
+			);
+		};
+		assert(describe(a) == 7);
+		assert(describe(nested {inner_a {"abc"}}) == 3);
+		assert(describe(nested {inner_b {1.F}}) == -1);
+		assert(describe(nested {'c'}) == -2);
+
+		nested c {inner_a {1}};
+		stdex::visit_flat(c, [](auto& x) { x = x + x; });
+		assert(c.get_unchecked<inner_a>().get<int>() == 2);
+	}
+
+	/* parsing json: */
+	{
+		using json = variant<std::nullptr_t, bool, std::int64_t, double, std::string_view>;
+		struct recorder final
+		{
+			std::vector<json> values { };
+			std::string       trace { };
+			std::size_t       documents {0};
+
+			auto value(json&& v) -> void { this->values.push_back(std::move(v)); this->trace += 'v'; }
+			auto key(const std::string_view k) -> void { this->trace += k; }
+			auto begin_object() -> void { this->trace += '{'; }
+			auto end_object() -> void { this->trace += '}'; }
+			auto begin_array() -> void { this->trace += '['; }
+			auto end_array() -> void { this->trace += ']'; }
+			auto end_document() -> void { ++this->documents; }
+		};
+
+		std::string text {R"( {"a": [1, -2.5e1, true, null], "b": "x\"y\u00e9\ud83d\ude00", "c": {}} )"};
+		recorder    r { };
+		assert(stdex::parse_json<json>(text.data(), text.size(), r).value() == text.size());
+		assert(r.trace == "{a[vvvv]bvc{}}");
+		assert(r.values[0].get_or_default<std::int64_t>() == 1 && r.values[1].get_or_default<double>() == -25.0);
+		assert(r.values[2].get_or_default<bool>() && r.values[3].holds_alternative<std::nullptr_t>());
+		assert(r.values[4].get_or_default<std::string_view>() == "x\"y\xC3\xA9\xF0\x9F\x98\x80");
+		assert(r.values[4].get_or_default<std::string_view>().data() > text.data() && r.values[4].get_or_default<std::string_view>().data() < text.data() + text.size());
+
+		std::string lines {"1\n\n\"a\"\r\n[18446744073709551616]\n"};
+		recorder    l { };
+		assert(stdex::parse_json_lines<json>(lines.data(), lines.size(), l).value() == 3 && l.documents == 3);
+		assert(l.values[2].holds_alternative<double>());
+
+		std::string broken {"[1, 01]"};
+		const auto  error {stdex::parse_json<json>(broken.data(), broken.size(), l)};
+		assert(!error && error.error().code == stdex::json_errc::invalid_number && error.error().offset == 4);
+		std::string trailing {"{} x"};
+		assert(stdex::parse_json<json>(trailing.data(), trailing.size(), l).error().code == stdex::json_errc::trailing_characters);
+	}
+
+	/* result: */
+	{
+		const auto parse = [](const int x) -> expected<int, std::string>
+		{
+			if (x < 0)
+			{
+				return unexpected {std::string {"negative"}};
+			}
+			return x;
+		};
+
+		const expected<int, std::string> a {parse(10)};
+		assert(a.has_value());
+		assert(a.value() == 10);
+		assert(a.value_or(3) == 10);
+
+		const expected<int, std::string> b {parse(-1)};
+		assert(!b);
+		assert(b.error() == "negative");
+		assert(b.value_or(3) == 3);
+
+		[[maybe_unused]] const auto twice = [](const int x) -> expected<int, std::string> { return x * 2; };
+		assert(a.and_then(twice).value() == 20);
+		assert(b.and_then(twice).error() == "negative");
+		assert(parse(4).and_then(twice).and_then(twice).value() == 16);
+
+		const auto c {a.transform([](const int x) { return static_cast<float>(x) * 0.5F; })};
+		static_assert(std::is_same_v<std::remove_const_t<decltype(c)>, expected<float, std::string>>);
+		assert(c.value() == 5.F);
+		assert(b.transform([](const int x) { return x + 1; }).error() == "negative");
+
+		assert(b.or_else([](const std::string& e) -> expected<int, std::string> { return static_cast<int>(e.size()); }).value() == 8);
+		assert(a.or_else([](const std::string&) -> expected<int, std::string> { return 0; }).value() == 10);
+
+		struct io_error final { int code; };
+		struct parse_error final { std::size_t column; };
+
+		result<std::string, io_error, parse_error> d {unexpected {parse_error {7}}};
+		assert(d.holds_error<parse_error>());
+		assert(!d.holds_error<io_error>());
+		assert(d.error<parse_error>().column == 7);
+
+		const auto e {std::move(d).transform([](std::string&& s) { return s.size(); })};
+		assert(e.holds_error<parse_error>());
+		assert(e.error<parse_error>().column == 7);
+
+		const auto f {e.or_else([](const auto& err) -> result<std::size_t, io_error, parse_error>
+		{
+			if constexpr (std::is_same_v<std::decay_t<decltype(err)>, parse_error>)
+			{
+				return err.column;
+			}
+			else
+			{
+				return unexpected {err};
+			}
+		})};
+		assert(f.value() == 7);
+
+		const result<int, int> g {unexpected {5}};
+		assert(!g.has_value());
+		assert(g.error() == 5);
+	}
+
 	std::cout << "All OK!\n";
 
 	return 0;
 }
+
+STDEX_VARIANT_INSTANTIATE(std::int16_t, std::string, double);